@@ -27,10 +27,7 @@ public class Multiplayer : ModuleRules
 			{
 				"Core",
 				"OnlineSubsystem",
-				"OnlineSubsystemSteam",
-				"UMG",
-				"Slate",
-				"SlateCore"
+				"OnlineSubsystemSteam"
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -41,8 +38,9 @@ public class Multiplayer : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
-				"Slate",
-				"SlateCore",
+				"Json",
+				"Sockets",
+				"Networking",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MultiplayerSessionAttributes.h"
+
+namespace
+{
+	template<typename ValueType>
+	bool MatchesKey(const FOnlineSessionSettings& Settings, const TMultiplayerSessionKey<ValueType>& Key, const ValueType& Wanted)
+	{
+		ValueType Value;
+		return Key.Read(Settings, Value) && Value == Wanted;
+	}
+}
+
+void FMultiplayerSessionAttributes::WriteTo(FOnlineSessionSettings& Settings) const
+{
+	if (!MatchType.IsEmpty())
+	{
+		MultiplayerSessionKeys::MatchType.Write(Settings, MatchType);
+	}
+	if (!Region.IsEmpty())
+	{
+		MultiplayerSessionKeys::Region.Write(Settings, Region);
+	}
+	if (!MapName.IsEmpty())
+	{
+		MultiplayerSessionKeys::MapName.Write(Settings, MapName);
+	}
+	if (BuildId != INDEX_NONE)
+	{
+		MultiplayerSessionKeys::BuildId.Write(Settings, BuildId);
+	}
+	if (SkillBucket != INDEX_NONE)
+	{
+		MultiplayerSessionKeys::SkillBucket.Write(Settings, SkillBucket);
+	}
+}
+
+void FMultiplayerSessionAttributes::WriteFilters(FOnlineSearchSettings& QuerySettings) const
+{
+	if (!MatchType.IsEmpty())
+	{
+		MultiplayerSessionKeys::MatchType.Filter(QuerySettings, MatchType);
+	}
+	if (!Region.IsEmpty())
+	{
+		MultiplayerSessionKeys::Region.Filter(QuerySettings, Region);
+	}
+	if (!MapName.IsEmpty())
+	{
+		MultiplayerSessionKeys::MapName.Filter(QuerySettings, MapName);
+	}
+	if (BuildId != INDEX_NONE)
+	{
+		MultiplayerSessionKeys::BuildId.Filter(QuerySettings, BuildId);
+	}
+	if (SkillBucket != INDEX_NONE)
+	{
+		MultiplayerSessionKeys::SkillBucket.Filter(QuerySettings, SkillBucket);
+	}
+}
+
+bool FMultiplayerSessionAttributes::Matches(const FOnlineSessionSettings& Settings) const
+{
+	return
+		(MatchType.IsEmpty() || MatchesKey(Settings, MultiplayerSessionKeys::MatchType, MatchType)) &&
+		(Region.IsEmpty() || MatchesKey(Settings, MultiplayerSessionKeys::Region, Region)) &&
+		(MapName.IsEmpty() || MatchesKey(Settings, MultiplayerSessionKeys::MapName, MapName)) &&
+		(BuildId == INDEX_NONE || MatchesKey(Settings, MultiplayerSessionKeys::BuildId, BuildId)) &&
+		(SkillBucket == INDEX_NONE || MatchesKey(Settings, MultiplayerSessionKeys::SkillBucket, SkillBucket));
+}
+
+FMultiplayerSessionAttributes FMultiplayerSessionAttributes::ReadFrom(const FOnlineSessionSettings& Settings)
+{
+	FMultiplayerSessionAttributes Attributes;
+	MultiplayerSessionKeys::MatchType.Read(Settings, Attributes.MatchType);
+	MultiplayerSessionKeys::Region.Read(Settings, Attributes.Region);
+	MultiplayerSessionKeys::MapName.Read(Settings, Attributes.MapName);
+	MultiplayerSessionKeys::BuildId.Read(Settings, Attributes.BuildId);
+	MultiplayerSessionKeys::SkillBucket.Read(Settings, Attributes.SkillBucket);
+	return Attributes;
+}
@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MultiplayerSessionMetrics.h"
+#include "Multiplayer.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/OutputDeviceRedirector.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	double ToMilliseconds(uint64 Microseconds)
+	{
+		return Microseconds / 1000.0;
+	}
+
+	FAutoConsoleCommand DumpLatencyCommand(
+		TEXT("Multiplayer.Sessions.DumpLatency"),
+		TEXT("Prints count, success/failure and p50/p95/p99 latency of every session operation"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FMultiplayerSessionMetrics::Get().Dump(*GLog);
+		}));
+
+	FAutoConsoleCommand ExportLatencyCsvCommand(
+		TEXT("Multiplayer.Sessions.ExportLatencyCsv"),
+		TEXT("Writes session operation latencies as CSV. Optional argument is the output directory, defaults to Saved/Profiling/MultiplayerSessions"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			const FString Directory = Args.Num() > 0 ? Args[0] : FPaths::ProfilingDir() / TEXT("MultiplayerSessions");
+			FMultiplayerSessionMetrics::Get().ExportCsv(Directory);
+		}));
+
+	FAutoConsoleCommand ResetLatencyCommand(
+		TEXT("Multiplayer.Sessions.ResetLatency"),
+		TEXT("Clears all session operation latencies and counters"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FMultiplayerSessionMetrics::Get().Reset();
+		}));
+}
+
+FMultiplayerSessionMetrics& FMultiplayerSessionMetrics::Get()
+{
+	static FMultiplayerSessionMetrics Metrics;
+	return Metrics;
+}
+
+void FMultiplayerSessionMetrics::Record(ESessionOperation Operation, double Seconds, bool bWasSuccessful)
+{
+	FOperationMetrics& Metrics = Operations[static_cast<int32>(Operation)];
+	Metrics.Histogram.Record(static_cast<uint64>(FMath::Max(Seconds, 0.0) * 1000000.0));
+	(bWasSuccessful ? Metrics.Successes : Metrics.Failures).fetch_add(1, std::memory_order_relaxed);
+}
+
+void FMultiplayerSessionMetrics::Reset()
+{
+	for (FOperationMetrics& Metrics : Operations)
+	{
+		Metrics.Histogram.Reset();
+		Metrics.Successes.store(0, std::memory_order_relaxed);
+		Metrics.Failures.store(0, std::memory_order_relaxed);
+		Metrics.Retries.store(0, std::memory_order_relaxed);
+		Metrics.Timeouts.store(0, std::memory_order_relaxed);
+		Metrics.Cancellations.store(0, std::memory_order_relaxed);
+		Metrics.Hedges.store(0, std::memory_order_relaxed);
+		Metrics.HedgeWins.store(0, std::memory_order_relaxed);
+	}
+}
+
+void FMultiplayerSessionMetrics::Dump(FOutputDevice& Ar) const
+{
+	for (int32 Index = 0; Index < static_cast<int32>(ESessionOperation::Count); ++Index)
+	{
+		const ESessionOperation Operation = static_cast<ESessionOperation>(Index);
+		const FSessionLatencyHistogram& Histogram = GetHistogram(Operation);
+
+		Ar.Logf(TEXT("%-8s count=%llu ok=%llu failed=%llu mean=%.2fms p50=%.2fms p95=%.2fms p99=%.2fms max=%.2fms retries=%llu timeouts=%llu cancelled=%llu hedges=%llu/%llu"),
+			LexToString(Operation),
+			Histogram.GetCount(),
+			GetSuccesses(Operation),
+			GetFailures(Operation),
+			Histogram.GetMean() / 1000.0,
+			ToMilliseconds(Histogram.GetPercentile(50.0)),
+			ToMilliseconds(Histogram.GetPercentile(95.0)),
+			ToMilliseconds(Histogram.GetPercentile(99.0)),
+			ToMilliseconds(Histogram.GetMax()),
+			GetRetries(Operation),
+			GetTimeouts(Operation),
+			GetCancellations(Operation),
+			GetHedgeWins(Operation),
+			GetHedges(Operation));
+	}
+}
+
+bool FMultiplayerSessionMetrics::ExportCsv(const FString& Directory) const
+{
+	FString Summary = TEXT("Operation,Count,Successes,Failures,MeanMs,P50Ms,P95Ms,P99Ms,MaxMs,Retries,Timeouts,Cancellations,Hedges,HedgeWins\n");
+	FString Buckets = TEXT("Operation,LowerUs,UpperUs,Count\n");
+
+	for (int32 Index = 0; Index < static_cast<int32>(ESessionOperation::Count); ++Index)
+	{
+		const ESessionOperation Operation = static_cast<ESessionOperation>(Index);
+		const FSessionLatencyHistogram& Histogram = GetHistogram(Operation);
+
+		Summary += FString::Printf(TEXT("%s,%llu,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%llu,%llu,%llu,%llu,%llu\n"),
+			LexToString(Operation),
+			Histogram.GetCount(),
+			GetSuccesses(Operation),
+			GetFailures(Operation),
+			Histogram.GetMean() / 1000.0,
+			ToMilliseconds(Histogram.GetPercentile(50.0)),
+			ToMilliseconds(Histogram.GetPercentile(95.0)),
+			ToMilliseconds(Histogram.GetPercentile(99.0)),
+			ToMilliseconds(Histogram.GetMax()),
+			GetRetries(Operation),
+			GetTimeouts(Operation),
+			GetCancellations(Operation),
+			GetHedges(Operation),
+			GetHedgeWins(Operation));
+
+		//Only filled buckets, the rest can be rebuilt from the bucket layout
+		for (int32 BucketIndex = 0; BucketIndex < FSessionLatencyHistogram::NumBuckets; ++BucketIndex)
+		{
+			const uint64 BucketCount = Histogram.GetBucketCount(BucketIndex);
+			if (BucketCount > 0)
+			{
+				Buckets += FString::Printf(TEXT("%s,%llu,%llu,%llu\n"),
+					LexToString(Operation),
+					FSessionLatencyHistogram::GetBucketLowerBound(BucketIndex),
+					FSessionLatencyHistogram::GetBucketUpperBound(BucketIndex),
+					BucketCount);
+			}
+		}
+	}
+
+	const FString Timestamp = FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S"));
+	const FString SummaryPath = Directory / FString::Printf(TEXT("SessionLatency-%s.csv"), *Timestamp);
+	const FString BucketsPath = Directory / FString::Printf(TEXT("SessionLatencyBuckets-%s.csv"), *Timestamp);
+
+	const bool bSaved =
+		FFileHelper::SaveStringToFile(Summary, *SummaryPath) &&
+		FFileHelper::SaveStringToFile(Buckets, *BucketsPath);
+
+	if (bSaved)
+	{
+		UE_LOG(LogMultiplayerSessions, Log, TEXT("Session latency written to %s"), *SummaryPath);
+	}
+	else
+	{
+		UE_LOG(LogMultiplayerSessions, Warning, TEXT("Could not write session latency to %s"), *Directory);
+	}
+	return bSaved;
+}
@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MultiplayerSessionSummary.h"
+#include "MultiplayerSessionAttributes.h"
+#include "OnlineSessionSettings.h"
+
+namespace
+{
+	template<typename ElementType>
+	void PermuteColumn(TArray<ElementType>& Column, const TArray<int32>& Order)
+	{
+		TArray<ElementType> Sorted;
+		Sorted.Reserve(Column.Num());
+		for (int32 Index : Order)
+		{
+			Sorted.Add(MoveTemp(Column[Index]));
+		}
+		Column = MoveTemp(Sorted);
+	}
+}
+
+FMultiplayerSessionSummary::FMultiplayerSessionSummary()
+{
+	Reset();
+}
+
+void FMultiplayerSessionSummary::Reset()
+{
+	SessionIds.Reset();
+	OwnerNames.Reset();
+	MatchTypes.Reset();
+	Regions.Reset();
+	MapNames.Reset();
+	BuildIds.Reset();
+	SkillBuckets.Reset();
+	Pings.Reset();
+	OpenSlots.Reset();
+	MaxSlots.Reset();
+	ServerLoads.Reset();
+	Flags.Reset();
+
+	Strings.Reset();
+	StringIndices.Reset();
+	SessionIndices.Reset();
+	Sources.Reset();
+	SourceIndices.Reset();
+	ResultIndices.Reset();
+
+	InternString(FString());
+}
+
+void FMultiplayerSessionSummary::Reserve(int32 NumSessions)
+{
+	SessionIds.Reserve(NumSessions);
+	OwnerNames.Reserve(NumSessions);
+	MatchTypes.Reserve(NumSessions);
+	Regions.Reserve(NumSessions);
+	MapNames.Reserve(NumSessions);
+	BuildIds.Reserve(NumSessions);
+	SkillBuckets.Reserve(NumSessions);
+	Pings.Reserve(NumSessions);
+	OpenSlots.Reserve(NumSessions);
+	MaxSlots.Reserve(NumSessions);
+	ServerLoads.Reserve(NumSessions);
+	Flags.Reserve(NumSessions);
+	SessionIndices.Reserve(NumSessions);
+	SourceIndices.Reserve(NumSessions);
+	ResultIndices.Reserve(NumSessions);
+}
+
+int32 FMultiplayerSessionSummary::Append(const TSharedPtr<FOnlineSessionSearch>& Search, uint8 ExtraFlags)
+{
+	if (!Search.IsValid())
+	{
+		return 0;
+	}
+
+	const int32 SourceIndex = Sources.Add(Search);
+	const int32 OldNum = Num();
+	Reserve(OldNum + Search->SearchResults.Num());
+
+	for (int32 ResultIndex = 0; ResultIndex < Search->SearchResults.Num(); ++ResultIndex)
+	{
+		const FOnlineSessionSearchResult& Result = Search->SearchResults[ResultIndex];
+		if (!SessionIndices.Contains(Result.GetSessionIdStr()))
+		{
+			Add(Result, SourceIndex, ResultIndex, ExtraFlags);
+		}
+	}
+
+	//Nothing new in it, no reason to keep it alive
+	if (Num() == OldNum)
+	{
+		Sources.Pop();
+	}
+	return Num() - OldNum;
+}
+
+void FMultiplayerSessionSummary::Append(const TArray<FOnlineSessionSearchResult>& Results)
+{
+	Reserve(Num() + Results.Num());
+	for (int32 ResultIndex = 0; ResultIndex < Results.Num(); ++ResultIndex)
+	{
+		Add(Results[ResultIndex], INDEX_NONE, ResultIndex, 0);
+	}
+}
+
+void FMultiplayerSessionSummary::Add(const FOnlineSessionSearchResult& Result, int32 SourceIndex, int32 ResultIndex, uint8 ExtraFlags)
+{
+	const FOnlineSession& Session = Result.Session;
+	const FOnlineSessionSettings& Settings = Session.SessionSettings;
+
+	FString Value;
+	const int32 MatchType = MultiplayerSessionKeys::MatchType.Read(Settings, Value) ? InternString(Value) : 0;
+	const int32 Region = MultiplayerSessionKeys::Region.Read(Settings, Value) ? InternString(Value) : 0;
+	const int32 MapName = MultiplayerSessionKeys::MapName.Read(Settings, Value) ? InternString(Value) : 0;
+
+	int32 BuildId = INDEX_NONE;
+	int32 SkillBucket = INDEX_NONE;
+	MultiplayerSessionKeys::BuildId.Read(Settings, BuildId);
+	MultiplayerSessionKeys::SkillBucket.Read(Settings, SkillBucket);
+
+	//Players the host reports beat the backend's count, which only knows about players registered with the session
+	int32 NumOpen = Session.NumOpenPublicConnections;
+	int32 PlayerCount = INDEX_NONE;
+	if (MultiplayerSessionKeys::PlayerCount.Read(Settings, PlayerCount))
+	{
+		NumOpen = FMath::Clamp(Settings.NumPublicConnections - PlayerCount, 0, NumOpen);
+	}
+
+	int32 ServerLoad = INDEX_NONE;
+	MultiplayerSessionKeys::ServerLoad.Read(Settings, ServerLoad);
+
+	uint8 SessionFlags = ExtraFlags;
+	SessionFlags |= Result.IsValid() ? Valid : 0;
+	SessionFlags |= Settings.bIsDedicated ? Dedicated : 0;
+	SessionFlags |= Settings.bAllowJoinInProgress ? JoinInProgress : 0;
+
+	const int32 Index = SessionIds.Add(Result.GetSessionIdStr());
+	SessionIndices.Add(SessionIds[Index], Index);
+	OwnerNames.Add(Session.OwningUserName);
+	MatchTypes.Add(MatchType);
+	Regions.Add(Region);
+	MapNames.Add(MapName);
+	BuildIds.Add(BuildId);
+	SkillBuckets.Add(SkillBucket);
+	Pings.Add(Result.PingInMs);
+	OpenSlots.Add(NumOpen);
+	MaxSlots.Add(Settings.NumPublicConnections);
+	ServerLoads.Add(ServerLoad);
+	Flags.Add(SessionFlags);
+	SourceIndices.Add(SourceIndex);
+	ResultIndices.Add(ResultIndex);
+}
+
+void FMultiplayerSessionSummary::SortByPing()
+{
+	TArray<int32> Order;
+	Order.Reserve(Num());
+	for (int32 Index = 0; Index < Num(); ++Index)
+	{
+		Order.Add(Index);
+	}
+	Order.StableSort([this](int32 A, int32 B)
+	{
+		return Pings[A] < Pings[B];
+	});
+
+	PermuteColumn(SessionIds, Order);
+	PermuteColumn(OwnerNames, Order);
+	PermuteColumn(MatchTypes, Order);
+	PermuteColumn(Regions, Order);
+	PermuteColumn(MapNames, Order);
+	PermuteColumn(BuildIds, Order);
+	PermuteColumn(SkillBuckets, Order);
+	PermuteColumn(Pings, Order);
+	PermuteColumn(OpenSlots, Order);
+	PermuteColumn(MaxSlots, Order);
+	PermuteColumn(ServerLoads, Order);
+	PermuteColumn(Flags, Order);
+	PermuteColumn(SourceIndices, Order);
+	PermuteColumn(ResultIndices, Order);
+
+	for (int32 Index = 0; Index < Num(); ++Index)
+	{
+		SessionIndices.Add(SessionIds[Index], Index);
+	}
+}
+
+const FOnlineSessionSearchResult* FMultiplayerSessionSummary::Resolve(int32 Index) const
+{
+	if (!SourceIndices.IsValidIndex(Index) || !Sources.IsValidIndex(SourceIndices[Index]))
+	{
+		return nullptr;
+	}
+
+	const TArray<FOnlineSessionSearchResult>& Results = Sources[SourceIndices[Index]]->SearchResults;
+	return Results.IsValidIndex(ResultIndices[Index]) ? &Results[ResultIndices[Index]] : nullptr;
+}
+
+int32 FMultiplayerSessionSummary::FindSession(const FString& SessionId) const
+{
+	const int32* Index = SessionIndices.Find(SessionId);
+	return Index ? *Index : INDEX_NONE;
+}
+
+int32 FMultiplayerSessionSummary::FindString(const FString& Value) const
+{
+	const int32* StringIndex = StringIndices.Find(Value);
+	return StringIndex ? *StringIndex : INDEX_NONE;
+}
+
+int32 FMultiplayerSessionSummary::InternString(const FString& Value)
+{
+	if (const int32* StringIndex = StringIndices.Find(Value))
+	{
+		return *StringIndex;
+	}
+
+	const int32 StringIndex = Strings.Add(Value);
+	StringIndices.Add(Value, StringIndex);
+	return StringIndex;
+}
@@ -2,15 +2,47 @@
 
 #include "MultiplayerSessionsSubsystem.h"
 #include"OnlineSubSystem.h"
+#include "OnlineSubsystemNames.h"
 #include "OnlineSessionSettings.h"
+#include "SessionSelector.h"
+#include "MultiplayerSessionMetrics.h"
+#include "OnlineSessionMock.h"
+#include "SessionPingProber.h"
+#include "Multiplayer.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/GameInstance.h"
+
+namespace
+{
+	//Hosted sessions are advertised on LAN under their own name, the NULL interface keeps its sessions apart from the platform's
+	const FName LanMirrorSessionName(TEXT("LanMirrorSession"));
+
+	bool IsSearchFinished(const TSharedPtr<FOnlineSessionSearch>& Search)
+	{
+		return Search.IsValid() && Search->SearchState != EOnlineAsyncTaskState::InProgress;
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpPoolCommand(
+		TEXT("Multiplayer.Sessions.DumpPool"),
+		TEXT("Prints size, claims and refill latency of the warm session pool"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+			UMultiplayerSessionsSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr;
+			if (Subsystem)
+			{
+				Subsystem->DumpSessionPool(Ar);
+			}
+		}));
+}
 
 UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem():
 
-	CreateSessionCompleteDelegate(FOnCreateSessionCompleteDelegate::CreateUObject(this,&ThisClass::OnCreateSessionComplete)),
 	FindSessionsCompleteDelegate(FOnFindSessionsCompleteDelegate::CreateUObject(this,&ThisClass::OnFindSessionsComplete)),
-	JoinSessionCompleteDelegate(FOnJoinSessionCompleteDelegate::CreateUObject(this,&ThisClass::OnJoinSessionComplete)),
-	DestroySessionCompleteDelegate(FOnDestroySessionCompleteDelegate::CreateUObject(this,&ThisClass::OnDestroySessionComplete)),
-	StartSessionCompleteDelegate(FOnStartSessionCompleteDelegate::CreateUObject(this,&ThisClass::OnStartSessionComplete))
+	LanFindSessionsCompleteDelegate(FOnFindSessionsCompleteDelegate::CreateUObject(this,&ThisClass::OnLanFindSessionsComplete))
 {
 	IOnlineSubsystem *Subsystem = IOnlineSubsystem::Get();
 
@@ -20,211 +52,2156 @@ UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem():
 	}
 }
 
+void UMultiplayerSessionsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	//Config is only loaded by now, the constructor is too early to decide on the backend
+	if (bUseMockSessionBackend || FParse::Param(FCommandLine::Get(), TEXT("MockSessionBackend")))
+	{
+		FMockSessionBackendSettings MockSettings;
+		MockSettings.NumSyntheticSessions = MockSessionCount;
+		MockSettings.LatencyMs = MockLatencyMs;
+		MockSettings.JitterMs = MockJitterMs;
+		MockSettings.FailureRate = MockFailureRate;
+		MockSettings.RandomSeed = MockRandomSeed;
+		MockSettings.NumHostPorts = MockHostPorts;
+		MockSettings.bRunProbeResponders = bMockProbeResponders;
+		MockSettings.ProbePortOffset = SessionProbePortOffset;
+
+		MockSessionBackend = MakeShared<FOnlineSessionMock, ESPMode::ThreadSafe>(MockSettings);
+		SessionInterface = MockSessionBackend;
+
+		UE_LOG(LogMultiplayerSessions, Log, TEXT("Using mock session backend with %d sessions, %.0f+-%.0fms latency, %.0f%% failures"),
+			MockSessionCount, MockLatencyMs, MockJitterMs, MockFailureRate * 100.0f);
+	}
+
+	//Platform backends can't run a LAN search next to their online one, the NULL subsystem can
+	if (bSearchLanAndOnline || bAdvertiseOnLan)
+	{
+		IOnlineSubsystem* NullSubsystem = IOnlineSubsystem::Get(NULL_SUBSYSTEM);
+		IOnlineSessionPtr NullSessionInterface = NullSubsystem ? NullSubsystem->GetSessionInterface() : nullptr;
+		if (NullSessionInterface.IsValid() && NullSessionInterface != SessionInterface)
+		{
+			LanSessionInterface = NullSessionInterface;
+		}
+	}
+
+	//Deadlines and retry backoffs are in the tens of milliseconds at the least, no need to check every frame
+	DeadlineTickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::TickOperationDeadlines), 0.05f);
+
+	//Headless hosts advertise themselves as soon as they are up, nobody is there to press Host
+	if (IsRunningDedicatedServer() && (bHostSessionOnDedicatedServer || FParse::Param(FCommandLine::Get(), TEXT("HostSession"))))
+	{
+		FMultiplayerSessionAttributes Attributes;
+		Attributes.MatchType = DedicatedServerMatchType;
+		FParse::Value(FCommandLine::Get(), TEXT("SessionMatchType="), Attributes.MatchType);
+
+		int32 NumPublicConnections = DedicatedServerConnections;
+		FParse::Value(FCommandLine::Get(), TEXT("SessionConnections="), NumPublicConnections);
+
+		UE_LOG(LogMultiplayerSessions, Log, TEXT("Hosting %s dedicated server session for %d players"), *Attributes.MatchType, NumPublicConnections);
+		CreateServerSession(NumPublicConnections, Attributes);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::Deinitialize()
+{
+	StopPrefetch();
+
+	if (PoolRetryTickHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(PoolRetryTickHandle);
+		PoolRetryTickHandle.Reset();
+	}
+
+	if (DeadlineTickHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(DeadlineTickHandle);
+		DeadlineTickHandle.Reset();
+	}
+
+	if (OccupancyTickHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(OccupancyTickHandle);
+		OccupancyTickHandle.Reset();
+	}
+
+	if (CandidateProber.IsValid())
+	{
+		CandidateProber->Cancel();
+		CandidateProber.Reset();
+	}
+	ProbeResponder.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UMultiplayerSessionsSubsystem::GetResolvedConnectString(FString& OutConnectString, FName SessionName) const
+{
+	IOnlineSessionPtr Interface = GetSessionInterfaceFor(SessionName);
+	return Interface.IsValid() && Interface->GetResolvedConnectString(SessionName, OutConnectString);
+}
+
+IOnlineSessionPtr UMultiplayerSessionsSubsystem::GetSessionInterfaceFor(FName SessionName) const
+{
+	if (LanSessionInterface.IsValid() && LanSessionInterface->GetNamedSession(SessionName))
+	{
+		return LanSessionInterface;
+	}
+	return SessionInterface;
+}
+
+bool UMultiplayerSessionsSubsystem::IsLanOnlyBackend() const
+{
+	const IOnlineSubsystem* Subsystem = IOnlineSubsystem::Get();
+	return !MockSessionBackend.IsValid() && Subsystem && Subsystem->GetSubsystemName() == NULL_SUBSYSTEM;
+}
+
+int32 UMultiplayerSessionsSubsystem::GetLocalControllerId() const
+{
+	const ULocalPlayer* LocalPlayer = GetWorld() ? GetWorld()->GetFirstLocalPlayerFromController() : nullptr;
+	return LocalPlayer ? LocalPlayer->GetControllerId() : 0;
+}
+
+FUniqueNetIdPtr UMultiplayerSessionsSubsystem::GetLocalUserId() const
+{
+	const ULocalPlayer* LocalPlayer = GetWorld() ? GetWorld()->GetFirstLocalPlayerFromController() : nullptr;
+	if (LocalPlayer == nullptr)
+	{
+		return nullptr;
+	}
+
+	const FUniqueNetIdRepl PlayerId = LocalPlayer->GetPreferredUniqueNetId();
+	return PlayerId.IsValid() ? PlayerId.GetUniqueNetId() : nullptr;
+}
+
+int32 UMultiplayerSessionsSubsystem::GetNumBoundBackendDelegates() const
+{
+	//Clear..._Handle resets the handle, so a valid one is still bound on the interface
+	int32 NumBound = SearchLane.CompleteDelegateHandle.IsValid() + LanFindSessionsCompleteDelegateHandle.IsValid();
+	for (const TPair<FName, TUniquePtr<FMultiplayerNamedSession>>& Entry : NamedSessions)
+	{
+		NumBound += Entry.Value->Lane.CompleteDelegateHandle.IsValid();
+	}
+	return NumBound;
+}
+
+int32 UMultiplayerSessionsSubsystem::GetNumPendingOperations() const
+{
+	int32 NumPending = SearchLane.PendingOperations.Num();
+	for (const TPair<FName, TUniquePtr<FMultiplayerNamedSession>>& Entry : NamedSessions)
+	{
+		NumPending += Entry.Value->Lane.PendingOperations.Num();
+	}
+	return NumPending;
+}
+
+bool UMultiplayerSessionsSubsystem::HasOperationInFlight() const
+{
+	if (SearchLane.bOperationInFlight)
+	{
+		return true;
+	}
+	for (const TPair<FName, TUniquePtr<FMultiplayerNamedSession>>& Entry : NamedSessions)
+	{
+		if (Entry.Value->Lane.bOperationInFlight)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+int32 UMultiplayerSessionsSubsystem::GetNumPendingBackendCalls() const
+{
+	return MockSessionBackend.IsValid() ? MockSessionBackend->GetNumPendingCalls() : 0;
+}
+
 
 //Session Functions
 
 void UMultiplayerSessionsSubsystem::CreateSession(int32 NumPublicConnections, FString MatchType)
 {
+	FMultiplayerSessionAttributes Attributes;
+	Attributes.MatchType = MatchType;
+	CreateSession(NumPublicConnections, Attributes);
+}
+
+void UMultiplayerSessionsSubsystem::CreateSession(int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes)
+{
+	//A warm session only needs an update and a start, both far quicker than a create
+	if (!ClaimWarmSession(NumPublicConnections, Attributes))
+	{
+		CreateSession(NAME_GameSession, NumPublicConnections, Attributes);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::CreateServerSession(int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes)
+{
+	CreateSession(NAME_GameSession, NumPublicConnections, Attributes, true);
+}
 
+void UMultiplayerSessionsSubsystem::CreateSession(FName SessionName, int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes, bool bDedicated, const FSessionOperationOptions& Options)
+{
 	if (!SessionInterface)
 	{
+		NotifySessionOperation(SessionName, ESessionOperation::Create, false);
 		return;
 	}
 
-	auto ExistingSessions = SessionInterface->GetNamedSession(NAME_GameSession);
-	if (ExistingSessions)
+	//An existing session is destroyed first when the create comes off the queue
+	FSessionOperation Operation;
+	Operation.Type = ESessionOperation::Create;
+	Operation.SessionName = SessionName;
+	Operation.NumPublicConnections = NumPublicConnections;
+	Operation.Attributes = Attributes;
+	Operation.bDedicated = bDedicated;
+	ApplyOperationOptions(Operation, Options);
+	EnqueueOperation(MoveTemp(Operation));
+}
+
+TArray<FName> UMultiplayerSessionsSubsystem::GetNamedSessionNames() const
+{
+	TArray<FName> SessionNames;
+	NamedSessions.GetKeys(SessionNames);
+	return SessionNames;
+}
+
+const FMultiplayerNamedSession* UMultiplayerSessionsSubsystem::GetNamedSession(FName SessionName) const
+{
+	const TUniquePtr<FMultiplayerNamedSession>* Session = NamedSessions.Find(SessionName);
+	return Session ? Session->Get() : nullptr;
+}
+
+FMultiplayerOnSessionOperationDelegate& UMultiplayerSessionsSubsystem::OnSessionOperation(FName SessionName)
+{
+	return FindOrAddNamedSession(SessionName).OnOperationComplete;
+}
+
+void UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults, const FMultiplayerSessionAttributes& Filter, const FSessionOperationOptions& Options)
+{
+
+	if (!SessionInterface.IsValid())
 	{
-		bCreateSessionOnDestroy = true;
-		LastNumPublicConnections = NumPublicConnections;
-		LastMatchType = MatchType;
-		DestroySessions();
+		return;
 	}
 
-	CreateSessionCompleteDelegateHandle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate);
+	//A plain search replaces any streaming or fan-out one still running
+	StreamingSearch.bActive = false;
+	FanOutSearch = FFanOutSearch();
 
-	LastSessionSettings = MakeShareable(new FOnlineSessionSettings());
-	LastSessionSettings->bIsLANMatch = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL" ? true : false;
-	LastSessionSettings->NumPublicConnections = NumPublicConnections;
-	LastSessionSettings->bAllowJoinInProgress = true;
-	LastSessionSettings->bAllowJoinViaPresence = true;
-	LastSessionSettings->bShouldAdvertise = true;
-	LastSessionSettings->bUsesPresence = true;
-	LastSessionSettings->Set(FName("MatchType"), MatchType, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
-	LastSessionSettings->BuildUniqueId = 1;
-	LastSessionSettings->bUseLobbiesIfAvailable = true;
+	const FMultiplayerSessionAttributes SearchFilter = ApplySessionDefaults(Filter);
 
-	const ULocalPlayer *LocalPlayer= GetWorld()->GetFirstLocalPlayerFromController();
-	bool bIsCreated = SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, *LastSessionSettings);
-	if (bIsCreated == false)
+	//LAN goes out first on its own interface, so it is on the wire while the online search may still wait in the queue
+	if (bSearchLanAndOnline && LanSessionInterface.IsValid())
+	{
+		SessionSummary.Reset();
+		LanSessionIds.Reset();
+		FanOutSearch.bActive = true;
+		FanOutSearch.NumPending = 2;
+		FanOutSearch.Filter = SearchFilter;
+		if (!StartLanSearch(MaxSearchResults, SearchFilter))
+		{
+			//Online results alone still make a complete answer
+			--FanOutSearch.NumPending;
+		}
+	}
+
+	TSharedPtr<FOnlineSessionSearch> NewSearch = MakeSessionSearch(MaxSearchResults, SearchFilter);
+	const FString SearchKey = FSessionSearchCache::MakeKey(*NewSearch);
+
+	if (bEnableSearchCache)
 	{
-		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
-		MultiplayerOnCreateSessionDelegate.Broadcast(false);
+		TSharedPtr<FOnlineSessionSearch> CachedSearch;
+		const FSessionSearchCache::ELookupResult Lookup = SearchCache.Find(SearchKey, FPlatformTime::Seconds(), SearchCacheTTL, SearchCacheStaleTTL, CachedSearch);
+
+		if (Lookup != FSessionSearchCache::ELookupResult::Miss)
+		{
+			UE_LOG(LogMultiplayerSessions, Verbose, TEXT("Serving %d %s cached search results"), CachedSearch->SearchResults.Num(),
+				Lookup == FSessionSearchCache::ELookupResult::Stale ? TEXT("stale") : TEXT("fresh"));
+
+			BroadcastFoundSessions(CachedSearch, true);
+
+			//Stale results were handed out, refresh them quietly in the background
+			if (Lookup == FSessionSearchCache::ELookupResult::Stale)
+			{
+				QueueSessionSearch(NewSearch, SearchKey, SearchFilter, false, FSessionOperationOptions(), true);
+			}
+			return;
+		}
 	}
+
+	QueueSessionSearch(NewSearch, SearchKey, SearchFilter, true, Options);
 }
 
-void UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults)
+void UMultiplayerSessionsSubsystem::FindSessionsStreaming(int32 MaxSearchResults, const FMultiplayerSessionAttributes& Filter, int32 PageSize, int32 StopAfterAcceptable, TFunction<bool(const FOnlineSessionSearchResult&)> IsAcceptable)
 {
-
 	if (!SessionInterface.IsValid())
 	{
 		return;
 	}
 
-	FindSessionsCompleteDelegateHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate);
-	LastSessionSearch = MakeShareable(new FOnlineSessionSearch());
-	if (GEngine)
+	FanOutSearch = FFanOutSearch();
+	StreamingSearch = FStreamingSearch();
+	StreamingSearch.bActive = true;
+	StreamingSearch.MaxSearchResults = MaxSearchResults;
+	StreamingSearch.PageSize = FMath::Clamp(PageSize, 1, MaxSearchResults);
+	StreamingSearch.StopAfterAcceptable = StopAfterAcceptable;
+	StreamingSearch.Filter = ApplySessionDefaults(Filter);
+	StreamingSearch.IsAcceptable = MoveTemp(IsAcceptable);
+	SessionSummary.Reset();
+	LanSessionIds.Reset();
+
+	//Replaces a plain search still running just as a plain search replaces this one, its answer only goes to the cache
+	bBroadcastSearchResults = false;
+	SearchLane.CurrentOperation.bBroadcastResults = false;
+	for (FSessionOperation& Pending : SearchLane.PendingOperations)
+	{
+		Pending.bBroadcastResults = false;
+	}
+
+	//LAN can't page, it answers once with everything while the online pages keep coming
+	if (bSearchLanAndOnline && LanSessionInterface.IsValid())
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Green, FString::Printf(TEXT("JoinButtonClicked1 %d sessions found"), LastSessionSearch->SearchResults.Num()));
+		FanOutSearch.Filter = StreamingSearch.Filter;
+		StreamingSearch.bLanPending = StartLanSearch(MaxSearchResults, StreamingSearch.Filter);
 	}
-	LastSessionSearch->MaxSearchResults = MaxSearchResults;
 
-	LastSessionSearch->bIsLanQuery = false;
-	LastSessionSearch->QuerySettings.Set(SEARCH_PRESENCE, true, EOnlineComparisonOp::Equals);
+	RequestNextSearchPage();
+}
 
-	//Local Player To Get Net PLayer Id
-	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	if (!SessionInterface->FindSessions(*LocalPlayer->GetPreferredUniqueNetId(), LastSessionSearch.ToSharedRef()))
+FMultiplayerSessionAttributes UMultiplayerSessionsSubsystem::ApplySessionDefaults(const FMultiplayerSessionAttributes& Attributes) const
+{
+	FMultiplayerSessionAttributes Resolved = Attributes;
+	if (Resolved.BuildId == INDEX_NONE)
+	{
+		Resolved.BuildId = SessionBuildId;
+	}
+	if (Resolved.Region.IsEmpty())
 	{
-		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
-		MultiplayerOnFindSessionDelegate.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		Resolved.Region = SessionRegion;
 	}
+	return Resolved;
 }
 
-void UMultiplayerSessionsSubsystem::JoinSessions(const FOnlineSessionSearchResult& SearchResult)
+TSharedPtr<FOnlineSessionSearch> UMultiplayerSessionsSubsystem::MakeSessionSearch(int32 MaxSearchResults, const FMultiplayerSessionAttributes& Filter) const
 {
-	if (GEngine)
+	TSharedPtr<FOnlineSessionSearch> NewSearch = MakeShareable(new FOnlineSessionSearch());
+	NewSearch->MaxSearchResults = MaxSearchResults;
+	NewSearch->bIsLanQuery = IsLanOnlyBackend();
+	if (!bSearchDedicatedServers)
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Green, FString("JoinButtonClicked5"));
+		NewSearch->QuerySettings.Set(SEARCH_PRESENCE, true, EOnlineComparisonOp::Equals);
 	}
+	Filter.WriteFilters(NewSearch->QuerySettings);
+	return NewSearch;
+}
 
-	if (!SessionInterface.IsValid())
+void UMultiplayerSessionsSubsystem::RequestNextSearchPage()
+{
+	//Backends can't resume a search, so every page asks for more results and only the new ones are handed out
+	StreamingSearch.RequestedResults = FMath::Min(StreamingSearch.PageSize << FMath::Min(StreamingSearch.PageIndex, 20), StreamingSearch.MaxSearchResults);
+
+	TSharedPtr<FOnlineSessionSearch> NewSearch = MakeSessionSearch(StreamingSearch.RequestedResults, StreamingSearch.Filter);
+	const FString SearchKey = FSessionSearchCache::MakeKey(*NewSearch);
+
+	//Only fresh pages are reused, a stale page would have to be refreshed anyway. Peeked so stale entries stay for plain searches
+	TSharedPtr<FOnlineSessionSearch> CachedSearch;
+	double CachedAge = 0.0;
+	if (bEnableSearchCache && SearchCache.Peek(SearchKey, FPlatformTime::Seconds(), CachedSearch, CachedAge) && CachedAge <= SearchCacheTTL)
 	{
-		MultiplayerOnJoinSessionDelegate.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
+		HandleSearchPage(CachedSearch, true, SearchCache.GetNumBackendResults(SearchKey));
 		return;
 	}
 
-	//Adding join delegate to interface delegate list
-	JoinSessionCompleteDelegateHandle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate);
+	//Pages are routed by their search, plain listeners don't get them
+	StreamingSearch.PageSearch = NewSearch;
+	QueueSessionSearch(NewSearch, SearchKey, StreamingSearch.Filter, false);
+}
+
+bool UMultiplayerSessionsSubsystem::IsStreamingPage(const FSessionOperation& Operation) const
+{
+	return StreamingSearch.bActive && Operation.Search.IsValid() && Operation.Search == StreamingSearch.PageSearch;
+}
+
+void UMultiplayerSessionsSubsystem::HandleSearchPage(const TSharedPtr<FOnlineSessionSearch>& Search, bool bWasSuccessful, int32 NumBackendResults, bool bFromLan)
+{
+	//The summary drops sessions earlier pages already handed out
+	const int32 FirstNewIndex = SessionSummary.Num();
+	SessionSummary.Append(Search, bFromLan ? FMultiplayerSessionSummary::Lan : 0);
+
+	for (int32 Index = FirstNewIndex; Index < SessionSummary.Num(); ++Index)
+	{
+		if (bFromLan)
+		{
+			LanSessionIds.Add(SessionSummary.SessionIds[Index]);
+		}
+		if (!StreamingSearch.IsAcceptable || StreamingSearch.IsAcceptable(*SessionSummary.Resolve(Index)))
+		{
+			++StreamingSearch.NumAcceptable;
+		}
+	}
+
+	if (bFromLan)
+	{
+		StreamingSearch.bLanPending = false;
+	}
+	else
+	{
+		//Fewer results than asked for means the backend has nothing more to give, counted before the local filter shrank the page
+		const int32 NumReturned = NumBackendResults != INDEX_NONE ? NumBackendResults : (Search.IsValid() ? Search->SearchResults.Num() : 0);
+		StreamingSearch.bOnlineDone =
+			!bWasSuccessful ||
+			NumReturned < StreamingSearch.RequestedResults ||
+			StreamingSearch.RequestedResults >= StreamingSearch.MaxSearchResults;
+	}
+
+	const bool bFoundEnough = StreamingSearch.StopAfterAcceptable > 0 && StreamingSearch.NumAcceptable >= StreamingSearch.StopAfterAcceptable;
+	const bool bIsFinalPage = bFoundEnough || (StreamingSearch.bOnlineDone && !StreamingSearch.bLanPending);
 
-	//Local Player To Get Net PLayer Id
-	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	if (!SessionInterface->JoinSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, SearchResult) )
+	const int32 PageIndex = StreamingSearch.PageIndex++;
+	if (bIsFinalPage)
 	{
-		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
-		MultiplayerOnJoinSessionDelegate.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
+		//A LAN answer arriving after this is dropped
+		StreamingSearch.bActive = false;
+		FanOutSearch.LanSearch.Reset();
+	}
+
+	const bool bFoundAny = bWasSuccessful || SessionSummary.Num() > 0;
+
+	//Full results are only copied out for listeners that still want them
+	if (MultiplayerOnFindSessionPageDelegate.IsBound())
+	{
+		TArray<FOnlineSessionSearchResult> PageResults;
+		PageResults.Reserve(SessionSummary.Num() - FirstNewIndex);
+		for (int32 Index = FirstNewIndex; Index < SessionSummary.Num(); ++Index)
+		{
+			PageResults.Add(*SessionSummary.Resolve(Index));
+		}
+		MultiplayerOnFindSessionPageDelegate.Broadcast(PageResults, PageIndex, bIsFinalPage, bFoundAny);
+	}
+	MultiplayerOnFindSessionSummaryDelegate.Broadcast(SessionSummary, bIsFinalPage, bFoundAny);
+
+	if (!bIsFinalPage && !bFromLan && !StreamingSearch.bOnlineDone && StreamingSearch.bActive)
+	{
+		RequestNextSearchPage();
 	}
 }
 
-void UMultiplayerSessionsSubsystem::DestroySessions()
+void UMultiplayerSessionsSubsystem::BroadcastFoundSessions(const TSharedPtr<FOnlineSessionSearch>& Search, bool bWasSuccessful)
 {
-	if (!SessionInterface.IsValid())
-	{ 
-		MultiplayerOnDestroySessionDelegate.Broadcast(false);
-		return; 
+	if (FanOutSearch.bActive)
+	{
+		HandleFanOutResult(Search, bWasSuccessful, false);
+		return;
 	}
 
-	DestroySessionCompleteDelegateHandle =  SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate);
+	SessionSummary.Reset();
+	SessionSummary.Append(Search);
+
+	const bool bFoundAny = bWasSuccessful && SessionSummary.Num() > 0;
+	MultiplayerOnFindSessionDelegate.Broadcast(Search->SearchResults, bFoundAny);
+	MultiplayerOnFindSessionSummaryDelegate.Broadcast(SessionSummary, true, bFoundAny);
+}
 
-	if (!SessionInterface->DestroySession(NAME_GameSession))
+bool UMultiplayerSessionsSubsystem::StartLanSearch(int32 MaxSearchResults, const FMultiplayerSessionAttributes& Filter)
+{
+	//The NULL interface only runs one search at a time, the previous fan-out gave up on its own
+	if (LanFindSessionsCompleteDelegateHandle.IsValid())
 	{
-		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
-		MultiplayerOnDestroySessionDelegate.Broadcast(false);
+		LanSessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(LanFindSessionsCompleteDelegateHandle);
+		LanSessionInterface->CancelFindSessions();
 	}
 
+	FanOutSearch.LanSearch = MakeSessionSearch(MaxSearchResults, Filter);
+	FanOutSearch.LanSearch->bIsLanQuery = true;
+
+	LanFindSessionsCompleteDelegateHandle = LanSessionInterface->AddOnFindSessionsCompleteDelegate_Handle(LanFindSessionsCompleteDelegate);
+	if (!LanSessionInterface->FindSessions(GetLocalControllerId(), FanOutSearch.LanSearch.ToSharedRef()))
+	{
+		LanSessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(LanFindSessionsCompleteDelegateHandle);
+		FanOutSearch.LanSearch.Reset();
+		return false;
+	}
+	return true;
 }
 
-void UMultiplayerSessionsSubsystem::StartSession()
+void UMultiplayerSessionsSubsystem::OnLanFindSessionsComplete(bool bWasSuccessful)
 {
-	if (!SessionInterface.IsValid())
+	if (LanSessionInterface.IsValid())
+	{
+		LanSessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(LanFindSessionsCompleteDelegateHandle);
+	}
+
+	const bool bStreaming = StreamingSearch.bActive && StreamingSearch.bLanPending;
+	if ((!FanOutSearch.bActive && !bStreaming) || !FanOutSearch.LanSearch.IsValid())
 	{
-		MultiplayerOnStartSessionDelegate.Broadcast(false);
 		return;
 	}
-	
-	StartSessionCompleteDelegateHandle = SessionInterface->AddOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate);
-	bool bSessionStarted = SessionInterface->StartSession(NAME_GameSession);
-	if (!bSessionStarted)
+
+	//NULL ignores QuerySettings
+	const TSharedPtr<FOnlineSessionSearch> LanSearch = FanOutSearch.LanSearch;
+	LanSearch->SearchResults.RemoveAll([this](const FOnlineSessionSearchResult& Result)
+	{
+		return !FanOutSearch.Filter.Matches(Result.Session.SessionSettings);
+	});
+
+	if (bStreaming)
 	{
-		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
-		MultiplayerOnStartSessionDelegate.Broadcast(false);
+		FanOutSearch.LanSearch.Reset();
+		HandleSearchPage(LanSearch, bWasSuccessful, INDEX_NONE, true);
+		return;
 	}
+	HandleFanOutResult(LanSearch, bWasSuccessful, true);
 }
 
+void UMultiplayerSessionsSubsystem::HandleFanOutResult(const TSharedPtr<FOnlineSessionSearch>& Search, bool bWasSuccessful, bool bFromLan)
+{
+	//Only sessions neither source handed out before make up this page, the summary drops the rest
+	TArray<FOnlineSessionSearchResult> PageResults;
+	if (Search.IsValid())
+	{
+		for (const FOnlineSessionSearchResult& Result : Search->SearchResults)
+		{
+			const FString SessionId = Result.GetSessionIdStr();
+			if (SessionSummary.FindSession(SessionId) != INDEX_NONE)
+			{
+				continue;
+			}
+			if (bFromLan)
+			{
+				LanSessionIds.Add(SessionId);
+			}
+			if (MultiplayerOnFindSessionPageDelegate.IsBound())
+			{
+				PageResults.Add(Result);
+			}
+		}
+	}
+
+	SessionSummary.Append(Search, bFromLan ? FMultiplayerSessionSummary::Lan : 0);
+	SessionSummary.SortByPing();
 
-//Delegates CallBack Functions
+	FanOutSearch.bAnySucceeded |= bWasSuccessful;
+	const bool bIsFinal = --FanOutSearch.NumPending <= 0;
+	const int32 PageIndex = FanOutSearch.PageIndex++;
+	if (bIsFinal)
+	{
+		FanOutSearch.bActive = false;
+		FanOutSearch.LanSearch.Reset();
+	}
+
+	const bool bFoundAny = FanOutSearch.bAnySucceeded && SessionSummary.Num() > 0;
+
+	//Whichever source answers first is handed out right away, the second completes the merge
+	if (MultiplayerOnFindSessionPageDelegate.IsBound())
+	{
+		PageResults.Sort([](const FOnlineSessionSearchResult& A, const FOnlineSessionSearchResult& B)
+		{
+			return A.PingInMs < B.PingInMs;
+		});
+		MultiplayerOnFindSessionPageDelegate.Broadcast(PageResults, PageIndex, bIsFinal, bFoundAny);
+	}
+	MultiplayerOnFindSessionSummaryDelegate.Broadcast(SessionSummary, bIsFinal, bFoundAny);
 
-void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, bool bWasSuccessful)
+	if (bIsFinal && MultiplayerOnFindSessionDelegate.IsBound())
+	{
+		TArray<FOnlineSessionSearchResult> MergedResults;
+		MergedResults.Reserve(SessionSummary.Num());
+		for (int32 Index = 0; Index < SessionSummary.Num(); ++Index)
+		{
+			MergedResults.Add(*SessionSummary.Resolve(Index));
+		}
+		MultiplayerOnFindSessionDelegate.Broadcast(MergedResults, bFoundAny);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::AdvertiseOnLan()
 {
-	if (SessionInterface)
+	const FMultiplayerNamedSession* HostedSession = GetNamedSession(HostedSessionName);
+	if (!bAdvertiseOnLan || !LanSessionInterface.IsValid() || HostedSession == nullptr || !HostedSession->Settings.IsValid() || LanSessionInterface->GetNamedSession(LanMirrorSessionName))
 	{
-		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
-		StartSession();
+		return;
 	}
 
-	MultiplayerOnCreateSessionDelegate.Broadcast(true);
+	//Fire and forget, the platform session is what players actually play in
+	FOnlineSessionSettings LanSettings = *HostedSession->Settings;
+	LanSettings.bIsLANMatch = true;
+	LanSettings.bUsesPresence = false;
+	LanSessionInterface->CreateSession(GetLocalControllerId(), LanMirrorSessionName, LanSettings);
 }
 
-void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessful)
+void UMultiplayerSessionsSubsystem::InvalidateSearchCache()
+{
+	SearchCache.Invalidate();
+}
+
+void UMultiplayerSessionsSubsystem::StartPrefetch(int32 MaxSearchResults, const FMultiplayerSessionAttributes& Filter, float IntervalSeconds)
+{
+	if (!SessionInterface.IsValid())
+	{
+		return;
+	}
+
+	StopPrefetch();
+
+	PrefetchFilter = ApplySessionDefaults(Filter);
+	PrefetchMaxResults = MaxSearchResults;
+	PrefetchSearchKey = FSessionSearchCache::MakeKey(*MakeSessionSearch(PrefetchMaxResults, PrefetchFilter));
+
+	const float Interval = IntervalSeconds > 0.0f ? IntervalSeconds : PrefetchIntervalSeconds;
+	PrefetchTickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::TickPrefetch), FMath::Max(Interval, 1.0f));
+
+	//The ticker first fires one interval from now, warm up right away
+	TickPrefetch(0.0f);
+}
+
+void UMultiplayerSessionsSubsystem::StopPrefetch()
+{
+	if (PrefetchTickHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(PrefetchTickHandle);
+		PrefetchTickHandle.Reset();
+	}
+}
+
+bool UMultiplayerSessionsSubsystem::TickPrefetch(float DeltaTime)
+{
+	//Anything else queued goes first, the next tick tries again
+	if (HasOperationInFlight() || GetNumPendingOperations() > 0)
+	{
+		return true;
+	}
+
+	QueueSessionSearch(MakeSessionSearch(PrefetchMaxResults, PrefetchFilter), PrefetchSearchKey, PrefetchFilter, false);
+	return true;
+}
+
+bool UMultiplayerSessionsSubsystem::JoinBestPrefetchedSession(const FMultiplayerSessionAttributes& Desired)
 {
-	if (GEngine)
+	if (PrefetchSearchKey.IsEmpty())
+	{
+		return false;
+	}
+
+	//Stale results are still worth a try, joins fall back to the next candidate when a host is gone
+	TSharedPtr<FOnlineSessionSearch> Prefetched;
+	double PrefetchedAge = 0.0;
+	if (!SearchCache.Peek(PrefetchSearchKey, FPlatformTime::Seconds(), Prefetched, PrefetchedAge) ||
+		PrefetchedAge > FMath::Max(SearchCacheTTL, SearchCacheStaleTTL) ||
+		Prefetched->SearchResults.Num() == 0)
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Green, FString::Printf(TEXT( "Search Results %d"), LastSessionSearch->SearchResults.Num() ));
+		return false;
 	}
 
-	if (SessionInterface.IsValid())
+	FMultiplayerSessionSummary Summary;
+	Summary.Append(Prefetched);
+	return JoinRankedCandidates(Summary, Desired, [&Summary](int32 Index)
+	{
+		return Summary.Resolve(Index);
+	}, false);
+}
+
+void UMultiplayerSessionsSubsystem::QueueSessionSearch(const TSharedPtr<FOnlineSessionSearch>& NewSearch, const FString& SearchKey, const FMultiplayerSessionAttributes& Filter, bool bBroadcastResults, const FSessionOperationOptions& Options, bool bCacheRefresh)
+{
+	FSessionOperation Operation;
+	Operation.Type = ESessionOperation::Find;
+	Operation.Search = NewSearch;
+	Operation.SearchKey = SearchKey;
+	Operation.Attributes = Filter;
+	Operation.bBroadcastResults = bBroadcastResults;
+	Operation.bCacheRefresh = bCacheRefresh;
+	ApplyOperationOptions(Operation, Options);
+	EnqueueOperation(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::JoinSessions(const FOnlineSessionSearchResult& SearchResult, const FSessionOperationOptions& Options)
+{
+	JoinSession(NAME_GameSession, SearchResult, Options);
+}
+
+void UMultiplayerSessionsSubsystem::JoinSession(FName SessionName, const FOnlineSessionSearchResult& SearchResult, const FSessionOperationOptions& Options)
+{
+	if (!SessionInterface.IsValid())
 	{
-		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+		if (SessionName == NAME_GameSession)
+		{
+			MultiplayerOnJoinSessionDelegate.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
+		}
+		NotifySessionOperation(SessionName, ESessionOperation::Join, false);
+		return;
 	}
 
-	if (LastSessionSearch->SearchResults.Num() <= 0)
+	FSessionOperation Operation;
+	Operation.Type = ESessionOperation::Join;
+	Operation.SessionName = SessionName;
+	Operation.SearchResult = MakeShared<FOnlineSessionSearchResult>(SearchResult);
+	ApplyOperationOptions(Operation, Options);
+	EnqueueOperation(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::JoinBestSession(const TArray<FOnlineSessionSearchResult>& Candidates, const FMultiplayerSessionAttributes& Desired)
+{
+	FMultiplayerSessionSummary Summary;
+	Summary.Append(Candidates);
+	JoinRankedCandidates(Summary, Desired, [&Candidates](int32 Index)
+	{
+		return &Candidates[Index];
+	});
+}
+
+void UMultiplayerSessionsSubsystem::JoinBestSession(const FMultiplayerSessionSummary& Summary, const FMultiplayerSessionAttributes& Desired)
+{
+	JoinRankedCandidates(Summary, Desired, [&Summary](int32 Index)
+	{
+		return Summary.Resolve(Index);
+	});
+}
+
+void UMultiplayerSessionsSubsystem::JoinSession(const FMultiplayerSessionSummary& Summary, int32 Index)
+{
+	const FOnlineSessionSearchResult* SearchResult = Summary.Resolve(Index);
+	if (SearchResult == nullptr)
 	{
-		MultiplayerOnFindSessionDelegate.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		MultiplayerOnJoinSessionDelegate.Broadcast(EOnJoinSessionCompleteResult::SessionDoesNotExist);
 		return;
 	}
 
-	MultiplayerOnFindSessionDelegate.Broadcast(LastSessionSearch->SearchResults, bWasSuccessful);
+	JoinSessions(*SearchResult);
 }
 
-void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
+bool UMultiplayerSessionsSubsystem::JoinRankedCandidates(const FMultiplayerSessionSummary& Summary, const FMultiplayerSessionAttributes& Desired, TFunctionRef<const FOnlineSessionSearchResult*(int32)> ResolveCandidate, bool bBroadcastIfNoneRanked)
 {
-	if (GEngine)
+	//One join at a time, competing joins on NAME_GameSession only fail each other
+	if (JoinCandidates.IsValidIndex(JoinCandidateIndex))
+	{
+		return true;
+	}
+
+	FSessionSelectionWeights Weights;
+	Weights.Ping = SelectionPingWeight;
+	Weights.OpenConnections = SelectionOpenConnectionsWeight;
+	Weights.AttributeMatch = SelectionAttributeMatchWeight;
+	Weights.HostQuality = SelectionHostQualityWeight;
+	Weights.MaxAcceptablePingMs = SelectionMaxAcceptablePingMs;
+
+	const FSessionSelector Selector(ApplySessionDefaults(Desired), Weights);
+	const int32 NumToRank = bProbeCandidatesBeforeJoin ? FMath::Max(ProbeCandidateCount, MaxJoinAttempts) : MaxJoinAttempts;
+	const TArray<int32> Ranked = Selector.Rank(Summary, NumToRank);
+
+	//Only the few we may fall back to are resolved and copied
+	JoinCandidates.Reset(Ranked.Num());
+	for (int32 CandidateIndex : Ranked)
+	{
+		if (const FOnlineSessionSearchResult* Candidate = ResolveCandidate(CandidateIndex))
+		{
+			JoinCandidates.Add(*Candidate);
+		}
+	}
+
+	if (JoinCandidates.Num() == 0)
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Green, FString("JoinButtonClicked6"));
+		if (bBroadcastIfNoneRanked)
+		{
+			MultiplayerOnJoinSessionDelegate.Broadcast(EOnJoinSessionCompleteResult::SessionDoesNotExist);
+		}
+		return false;
 	}
 
-	if (SessionInterface)
+	JoinCandidateIndex = 0;
+	if (bProbeCandidatesBeforeJoin && ProbeJoinCandidates(Selector))
 	{
-		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
+		return true;
 	}
 
-	MultiplayerOnJoinSessionDelegate.Broadcast(Result);
+	JoinCandidates.SetNum(FMath::Min(JoinCandidates.Num(), MaxJoinAttempts));
+	JoinSessions(JoinCandidates[JoinCandidateIndex]);
+	return true;
 }
 
-void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName, bool bWasSuccessful)
+bool UMultiplayerSessionsSubsystem::ProbeJoinCandidates(const FSessionSelector& Selector)
 {
-	if (SessionInterface)
+	TArray<TSharedPtr<FInternetAddr>> Targets;
+	TArray<int32> ProbedCandidates;
+	for (int32 CandidateIndex = 0; CandidateIndex < JoinCandidates.Num(); ++CandidateIndex)
 	{
-		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
+		const FOnlineSessionSearchResult& Candidate = JoinCandidates[CandidateIndex];
+		IOnlineSessionPtr Interface = LanSessionIds.Contains(Candidate.GetSessionIdStr()) && LanSessionInterface.IsValid() ? LanSessionInterface : SessionInterface;
+
+		FString ConnectString;
+		if (!Interface->GetResolvedConnectString(Candidate, NAME_GamePort, ConnectString))
+		{
+			continue;
+		}
+
+		if (TSharedPtr<FInternetAddr> Address = FSessionPingProber::ResolveProbeAddress(ConnectString, SessionProbePortOffset))
+		{
+			Targets.Add(Address);
+			ProbedCandidates.Add(CandidateIndex);
+		}
 	}
 
-	if (bWasSuccessful && bCreateSessionOnDestroy)
+	if (Targets.Num() == 0)
 	{
-		bCreateSessionOnDestroy = false;
-		CreateSession(LastNumPublicConnections, LastMatchType);
+		return false;
 	}
 
-	MultiplayerOnDestroySessionDelegate.Broadcast(true);
+	//Candidates stay reserved through JoinCandidateIndex while the probes are out, so a second join waits its turn
+	TWeakObjectPtr<UMultiplayerSessionsSubsystem> WeakThis(this);
+	CandidateProber = MakeShared<FSessionPingProber>();
+	const bool bStarted = CandidateProber->Start(Targets, ProbeBudgetMs / 1000.0f, [WeakThis, Selector, ProbedCandidates](const TArray<int32>& RttMs)
+	{
+		if (WeakThis.IsValid())
+		{
+			WeakThis->OnJoinCandidatesProbed(Selector, ProbedCandidates, RttMs);
+		}
+	});
+
+	if (!bStarted)
+	{
+		CandidateProber.Reset();
+	}
+	return bStarted;
 }
 
-void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessful)
+void UMultiplayerSessionsSubsystem::OnJoinCandidatesProbed(const FSessionSelector& Selector, const TArray<int32>& ProbedCandidates, const TArray<int32>& RttMs)
 {
-	if (SessionInterface)
+	CandidateProber.Reset();
+
+	int32 NumAnswered = 0;
+	for (int32 TargetIndex = 0; TargetIndex < ProbedCandidates.Num(); ++TargetIndex)
 	{
-		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
+		FOnlineSessionSearchResult& Candidate = JoinCandidates[ProbedCandidates[TargetIndex]];
+		if (RttMs[TargetIndex] != INDEX_NONE)
+		{
+			Candidate.PingInMs = RttMs[TargetIndex];
+			++NumAnswered;
+		}
+		else
+		{
+			//Silent within the budget, rank it as far away as we still accept
+			Candidate.PingInMs = FMath::Max(Candidate.PingInMs, SelectionMaxAcceptablePingMs);
+		}
 	}
 
+	UE_LOG(LogMultiplayerSessions, Log, TEXT("Probed %d join candidates, %d answered within %.0fms"), ProbedCandidates.Num(), NumAnswered, ProbeBudgetMs);
+
+	//Same scoring as the search ranking, only on measured pings
+	FMultiplayerSessionSummary Probed;
+	Probed.Append(JoinCandidates);
+	const TArray<int32> Reranked = Selector.Rank(Probed, MaxJoinAttempts);
+
+	TArray<FOnlineSessionSearchResult> Ordered;
+	Ordered.Reserve(Reranked.Num());
+	for (int32 CandidateIndex : Reranked)
+	{
+		Ordered.Add(JoinCandidates[CandidateIndex]);
+	}
+	JoinCandidates = MoveTemp(Ordered);
+
+	if (JoinCandidates.Num() == 0)
+	{
+		JoinCandidateIndex = INDEX_NONE;
+		MultiplayerOnJoinSessionDelegate.Broadcast(EOnJoinSessionCompleteResult::SessionDoesNotExist);
+		return;
+	}
+
+	JoinCandidateIndex = 0;
+	JoinSessions(JoinCandidates[JoinCandidateIndex]);
+}
+
+
+void UMultiplayerSessionsSubsystem::DestroySessions()
+{
+	DestroySession(HostedSessionName);
+}
+
+void UMultiplayerSessionsSubsystem::StartSession()
+{
+	StartSession(HostedSessionName);
+}
+
+void UMultiplayerSessionsSubsystem::DestroySession(FName SessionName, const FSessionOperationOptions& Options)
+{
+	if (!SessionInterface.IsValid())
+	{ 
+		NotifySessionOperation(SessionName, ESessionOperation::Destroy, false);
+		return; 
+	}
+
+	FSessionOperation Operation;
+	Operation.Type = ESessionOperation::Destroy;
+	Operation.SessionName = SessionName;
+	ApplyOperationOptions(Operation, Options);
+	EnqueueOperation(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::StartSession(FName SessionName, const FSessionOperationOptions& Options)
+{
+	if (!SessionInterface.IsValid())
+	{
+		NotifySessionOperation(SessionName, ESessionOperation::Start, false);
+		return;
+	}
+
+	FSessionOperation Operation;
+	Operation.Type = ESessionOperation::Start;
+	Operation.SessionName = SessionName;
+	ApplyOperationOptions(Operation, Options);
+	EnqueueOperation(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::UpdateSession(FName SessionName, int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes, bool bShouldAdvertise, const FSessionOperationOptions& Options)
+{
+	if (!SessionInterface.IsValid())
+	{
+		NotifySessionOperation(SessionName, ESessionOperation::Update, false);
+		return;
+	}
+
+	FSessionOperation Operation;
+	Operation.Type = ESessionOperation::Update;
+	Operation.SessionName = SessionName;
+	Operation.NumPublicConnections = NumPublicConnections;
+	Operation.Attributes = Attributes;
+	Operation.bAdvertise = bShouldAdvertise;
+	ApplyOperationOptions(Operation, Options);
+	EnqueueOperation(MoveTemp(Operation));
+}
+
+void UMultiplayerSessionsSubsystem::NotifySessionOperation(FName SessionName, ESessionOperation Type, bool bWasSuccessful)
+{
+	FMultiplayerNamedSession& Session = FindOrAddNamedSession(SessionName);
+	IOnlineSessionPtr Interface = GetSessionInterfaceFor(SessionName);
+	Session.State = Interface.IsValid() ? Interface->GetSessionState(SessionName) : EOnlineSessionState::NoSession;
+	if (Session.State == EOnlineSessionState::NoSession)
+	{
+		Session.Settings.Reset();
+		Session.bIsHost = false;
+	}
+
+	//Menus and the benchmark only know about the game session and whatever this process hosts
+	if (SessionName == NAME_GameSession || SessionName == HostedSessionName)
+	{
+		switch (Type)
+		{
+		case ESessionOperation::Create:
+			MultiplayerOnCreateSessionDelegate.Broadcast(bWasSuccessful);
+			break;
+
+		case ESessionOperation::Start:
+			MultiplayerOnStartSessionDelegate.Broadcast(bWasSuccessful);
+			break;
+
+		case ESessionOperation::Destroy:
+			MultiplayerOnDestroySessionDelegate.Broadcast(bWasSuccessful);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	//Listeners may open other sessions from in here, broadcast from a copy
+	const FMultiplayerOnSessionOperationDelegate OnOperationComplete = Session.OnOperationComplete;
+	MultiplayerOnSessionOperationDelegate.Broadcast(SessionName, Type, bWasSuccessful);
+	OnOperationComplete.Broadcast(SessionName, Type, bWasSuccessful);
+
+	//Unless a listener already claimed the next one, host calls go back to the game session.
+	//Whatever is hosted next starts without occupancy, so everything reported goes out again
+	if (Type == ESessionOperation::Destroy && bWasSuccessful && HostedSessionName == SessionName)
+	{
+		HostedSessionName = NAME_GameSession;
+		Occupancy.PushedPlayers = INDEX_NONE;
+		Occupancy.PushedLoad = INDEX_NONE;
+	}
+}
+
+
+//Operation Queue
+
+FMultiplayerNamedSession& UMultiplayerSessionsSubsystem::FindOrAddNamedSession(FName SessionName)
+{
+	if (TUniquePtr<FMultiplayerNamedSession>* Existing = NamedSessions.Find(SessionName))
+	{
+		return **Existing;
+	}
+
+	//Boxed so lanes keep their address while other sessions are added
+	TUniquePtr<FMultiplayerNamedSession>& Added = NamedSessions.Add(SessionName, MakeUnique<FMultiplayerNamedSession>());
+	Added->SessionName = SessionName;
+	return *Added;
+}
+
+FSessionOperationLane& UMultiplayerSessionsSubsystem::GetLane(const FSessionOperation& Operation)
+{
+	//Searches aren't tied to a session, they share one lane of their own
+	return Operation.Type == ESessionOperation::Find ? SearchLane : FindOrAddNamedSession(Operation.SessionName).Lane;
+}
+
+FSessionOperationLane* UMultiplayerSessionsSubsystem::FindLane(FName SessionName)
+{
+	const TUniquePtr<FMultiplayerNamedSession>* Session = NamedSessions.Find(SessionName);
+	return Session ? &(*Session)->Lane : nullptr;
+}
+
+void UMultiplayerSessionsSubsystem::EnqueueOperation(FSessionOperation&& Operation)
+{
+	Operation.EnqueuedTime = FPlatformTime::Seconds();
+	if (Operation.Deadline <= 0.0)
+	{
+		Operation.Deadline = OperationTimeoutSeconds > 0.0f ? Operation.EnqueuedTime + OperationTimeoutSeconds : MAX_dbl;
+	}
+
+	FSessionOperationLane& Lane = GetLane(Operation);
+
+	//Same search already on the wire, let it answer this call too
+	if (Operation.Type == ESessionOperation::Find && Lane.bOperationInFlight && Lane.CurrentOperation.SearchKey == Operation.SearchKey)
+	{
+		bBroadcastSearchResults |= Operation.bBroadcastResults;
+		MergeSearchCaller(Lane.CurrentOperation, Operation);
+		return;
+	}
+
+	//Start and destroy already on the wire will broadcast to this caller as well
+	if ((Operation.Type == ESessionOperation::Start || Operation.Type == ESessionOperation::Destroy) &&
+		Lane.bOperationInFlight && Lane.CurrentOperation.Type == Operation.Type)
+	{
+		return;
+	}
+
+	for (FSessionOperation& Pending : Lane.PendingOperations)
+	{
+		if (Pending.Type != Operation.Type || Pending.bRequiresPreviousSuccess)
+		{
+			continue;
+		}
+
+		switch (Operation.Type)
+		{
+		case ESessionOperation::Find:
+			if (Pending.SearchKey == Operation.SearchKey)
+			{
+				Pending.bBroadcastResults |= Operation.bBroadcastResults;
+				MergeSearchCaller(Pending, Operation);
+				return;
+			}
+			break;
+
+		//Latest settings and latest pick win, there is no point running the older request first
+		case ESessionOperation::Create:
+		case ESessionOperation::Join:
+			Pending = MoveTemp(Operation);
+			return;
+
+		//An occupancy push only writes the counts and a settings update leaves them out, neither may replace the other
+		case ESessionOperation::Update:
+			if (Pending.bPushOccupancy == Operation.bPushOccupancy)
+			{
+				Pending = MoveTemp(Operation);
+				return;
+			}
+			break;
+
+		case ESessionOperation::Start:
+		case ESessionOperation::Destroy:
+			return;
+
+		default:
+			break;
+		}
+	}
+
+	Lane.PendingOperations.Add(MoveTemp(Operation));
+	PumpOperations();
+}
+
+void UMultiplayerSessionsSubsystem::PumpOperations()
+{
+	//Operations failing synchronously complete from inside ExecuteOperation, the outer loop keeps going
+	if (bPumpingOperations)
+	{
+		return;
+	}
+
+	TGuardValue<bool> PumpGuard(bPumpingOperations, true);
+
+	//Completions and callbacks may add lanes or free one up again, go round until none of them moves
+	bool bStartedAny = true;
+	while (bStartedAny)
+	{
+		bStartedAny = false;
+		const double Now = FPlatformTime::Seconds();
+
+		TArray<FSessionOperationLane*, TInlineAllocator<8>> Lanes;
+		Lanes.Add(&SearchLane);
+		for (TPair<FName, TUniquePtr<FMultiplayerNamedSession>>& Entry : NamedSessions)
+		{
+			Lanes.Add(&Entry.Value->Lane);
+		}
+
+		for (FSessionOperationLane* Lane : Lanes)
+		{
+			//A retry waiting out its backoff holds up its lane, the deadline ticker pumps again once it is due
+			if (!Lane->bOperationInFlight && Lane->PendingOperations.Num() > 0 && Lane->PendingOperations[0].NotBefore <= Now)
+			{
+				Lane->CurrentOperation = MoveTemp(Lane->PendingOperations[0]);
+				Lane->PendingOperations.RemoveAt(0);
+				Lane->CurrentOperation.AttemptStartTime = Now;
+				Lane->bOperationInFlight = true;
+				ExecuteOperation(*Lane);
+				bStartedAny = true;
+			}
+		}
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ExecuteOperation(FSessionOperationLane& Lane)
+{
+	FSessionOperation& Operation = Lane.CurrentOperation;
+
+	//Given up on while it waited in the queue, never goes to the backend
+	const bool bCancelled = Operation.IsCancelled();
+	if (bCancelled || FPlatformTime::Seconds() >= Operation.Deadline)
+	{
+		if (bCancelled)
+		{
+			FMultiplayerSessionMetrics::Get().RecordCancellation(Operation.Type);
+		}
+		else
+		{
+			FMultiplayerSessionMetrics::Get().RecordTimeout(Operation.Type);
+		}
+		BroadcastOperationFailure(Operation);
+		CompleteOperation(Lane, false);
+		return;
+	}
+
+	FNamedOnlineSession* ExistingSession = GetSessionInterfaceFor(Operation.SessionName)->GetNamedSession(Operation.SessionName);
+
+	switch (Operation.Type)
+	{
+	case ESessionOperation::Create:
+	case ESessionOperation::Join:
+		if (ExistingSession)
+		{
+			//Destroy first and run this again once that succeeded
+			FSessionOperation DestroyOperation;
+			DestroyOperation.Type = ESessionOperation::Destroy;
+			DestroyOperation.SessionName = Operation.SessionName;
+			DestroyOperation.EnqueuedTime = FPlatformTime::Seconds();
+			DestroyOperation.Deadline = Operation.Deadline;
+			DestroyOperation.CancellationToken = Operation.CancellationToken;
+
+			Operation.bRequiresPreviousSuccess = true;
+			Lane.PendingOperations.Insert(MoveTemp(Operation), 0);
+			Lane.PendingOperations.Insert(MoveTemp(DestroyOperation), 0);
+			Lane.bOperationInFlight = false;
+			return;
+		}
+
+		if (Operation.Type == ESessionOperation::Create)
+		{
+			ExecuteCreateSession(Lane);
+		}
+		else
+		{
+			ExecuteJoinSession(Lane);
+		}
+		break;
+
+	case ESessionOperation::Find:
+		ExecuteFindSessions(Lane);
+		break;
+
+	case ESessionOperation::Destroy:
+		//Nothing to destroy, skip the round trip
+		if (ExistingSession == nullptr)
+		{
+			NotifySessionOperation(Operation.SessionName, ESessionOperation::Destroy, true);
+			CompleteOperation(Lane, true);
+			return;
+		}
+		ExecuteDestroySession(Lane);
+		break;
+
+	case ESessionOperation::Start:
+		if (ExistingSession == nullptr)
+		{
+			NotifySessionOperation(Operation.SessionName, ESessionOperation::Start, false);
+			CompleteOperation(Lane, false);
+			return;
+		}
+		if (ExistingSession->SessionState == EOnlineSessionState::InProgress)
+		{
+			NotifySessionOperation(Operation.SessionName, ESessionOperation::Start, true);
+			CompleteOperation(Lane, true);
+			return;
+		}
+		ExecuteStartSession(Lane);
+		break;
+
+	case ESessionOperation::Update:
+		if (ExistingSession == nullptr)
+		{
+			OnUpdateSessionComplete(Operation.SessionName, false, Operation.SessionName);
+			return;
+		}
+		ExecuteUpdateSession(Lane);
+		break;
+
+	default:
+		CompleteOperation(Lane, false);
+		break;
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ApplyOperationOptions(FSessionOperation& Operation, const FSessionOperationOptions& Options) const
+{
+	//Left at 0 the queue stamps OperationTimeoutSeconds on it
+	if (Options.TimeoutSeconds > 0.0f)
+	{
+		Operation.Deadline = FPlatformTime::Seconds() + Options.TimeoutSeconds;
+	}
+	else if (Options.TimeoutSeconds < 0.0f)
+	{
+		Operation.Deadline = MAX_dbl;
+	}
+	Operation.CancellationToken = Options.CancellationToken;
+}
+
+void UMultiplayerSessionsSubsystem::MergeSearchCaller(FSessionOperation& Search, const FSessionOperation& Caller)
+{
+	//Answers everyone now, so it runs until the last caller's deadline and can't be cancelled by just one of them
+	Search.Deadline = FMath::Max(Search.Deadline, Caller.Deadline);
+	if (Search.CancellationToken != Caller.CancellationToken)
+	{
+		Search.CancellationToken.Reset();
+	}
+
+	//Its answer refreshes the caller's entry just the same
+	Search.bCacheRefresh |= Caller.bCacheRefresh;
+
+	//A streaming page riding on another search takes that search's answer as its own
+	if (Caller.Search.IsValid() && Caller.Search == StreamingSearch.PageSearch)
+	{
+		StreamingSearch.PageSearch = Search.Search;
+	}
+}
+
+bool UMultiplayerSessionsSubsystem::TickOperationDeadlines(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	TArray<FSessionOperationLane*, TInlineAllocator<8>> Lanes;
+	Lanes.Add(&SearchLane);
+	for (TPair<FName, TUniquePtr<FMultiplayerNamedSession>>& Entry : NamedSessions)
+	{
+		Lanes.Add(&Entry.Value->Lane);
+	}
+
+	for (FSessionOperationLane* Lane : Lanes)
+	{
+		if (!Lane->bOperationInFlight)
+		{
+			continue;
+		}
+
+		const FSessionOperation& Operation = Lane->CurrentOperation;
+		const bool bCancelled = Operation.IsCancelled();
+		const bool bAttemptTimedOut = AttemptTimeoutSeconds > 0.0f && Now - Operation.AttemptStartTime >= AttemptTimeoutSeconds;
+		if (bCancelled || bAttemptTimedOut || Now >= Operation.Deadline)
+		{
+			AbandonOperation(*Lane, bCancelled);
+		}
+		else if (Lane == &SearchLane && bHedgeFindSessions && Operation.Type == ESessionOperation::Find && !Operation.bHedged)
+		{
+			HedgeFindSessions(Now);
+		}
+	}
+
+	//Releases retries whose backoff ran out
+	PumpOperations();
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::AbandonOperation(FSessionOperationLane& Lane, bool bCancelled)
+{
+	const FSessionOperation& Operation = Lane.CurrentOperation;
+	const FName SessionName = Operation.SessionName;
+
+	if (bCancelled)
+	{
+		FMultiplayerSessionMetrics::Get().RecordCancellation(Operation.Type);
+	}
+	else
+	{
+		FMultiplayerSessionMetrics::Get().RecordTimeout(Operation.Type);
+	}
+
+	UE_LOG(LogMultiplayerSessions, Log, TEXT("%s of %s %s after %.1fs on attempt %d"),
+		LexToString(Operation.Type), *SessionName.ToString(), bCancelled ? TEXT("cancelled") : TEXT("timed out"),
+		FPlatformTime::Seconds() - Operation.EnqueuedTime, Operation.Attempt + 1);
+
+	//The callbacks clear the backend delegate, so a late answer can't land on the next operation in this lane.
+	//A late successful create or join leaves a session behind, the next one on that name destroys it first
+	switch (Operation.Type)
+	{
+	case ESessionOperation::Create:
+		OnCreateSessionComplete(SessionName, false, SessionName);
+		break;
+
+	case ESessionOperation::Find:
+		if (Lane.OperationInterface.IsValid())
+		{
+			Lane.OperationInterface->CancelFindSessions();
+		}
+		FinishFindSessions(false);
+		break;
+
+	case ESessionOperation::Join:
+		OnJoinSessionComplete(SessionName, EOnJoinSessionCompleteResult::UnknownError, SessionName);
+		break;
+
+	case ESessionOperation::Start:
+		OnStartSessionComplete(SessionName, false, SessionName);
+		break;
+
+	case ESessionOperation::Destroy:
+		OnDestroySessionComplete(SessionName, false, SessionName);
+		break;
+
+	case ESessionOperation::Update:
+		OnUpdateSessionComplete(SessionName, false, SessionName);
+		break;
+
+	default:
+		CompleteOperation(Lane, false);
+		break;
+	}
+}
+
+bool UMultiplayerSessionsSubsystem::RetryOperation(FSessionOperationLane& Lane)
+{
+	FSessionOperation& Operation = Lane.CurrentOperation;
+	if (Operation.Attempt >= MaxOperationRetries || Operation.IsCancelled())
+	{
+		return false;
+	}
+
+	//Nothing left to start or update, another attempt would fail the same way
+	if ((Operation.Type == ESessionOperation::Start || Operation.Type == ESessionOperation::Update) &&
+		GetSessionInterfaceFor(Operation.SessionName)->GetNamedSession(Operation.SessionName) == nullptr)
+	{
+		return false;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const double Backoff = FMath::Min(RetryBackoffSeconds * FMath::Pow(RetryBackoffMultiplier, static_cast<float>(Operation.Attempt)), MaxRetryBackoffSeconds)
+		* (1.0 - FMath::FRand() * FMath::Clamp(RetryBackoffJitter, 0.0f, 1.0f));
+	if (Now + Backoff >= Operation.Deadline)
+	{
+		return false;
+	}
+
+	FMultiplayerSessionMetrics::Get().RecordRetry(Operation.Type);
+	UE_LOG(LogMultiplayerSessions, Verbose, TEXT("Retrying %s of %s in %.0fms"), LexToString(Operation.Type), *Operation.SessionName.ToString(), Backoff * 1000.0);
+
+	FSessionOperation Retry = MoveTemp(Operation);
+	++Retry.Attempt;
+	Retry.NotBefore = Now + Backoff;
+	Retry.bRequiresPreviousSuccess = false;
+	Retry.HedgeSearch.Reset();
+	Retry.bHedged = false;
+
+	Lane.PendingOperations.Insert(MoveTemp(Retry), 0);
+	Lane.bOperationInFlight = false;
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::HedgeFindSessions(double Now)
+{
+	FSessionOperation& Operation = SearchLane.CurrentOperation;
+
+	//Queue wait and retries are in there too, so the percentile errs on the late side
+	const FSessionLatencyHistogram& Histogram = FMultiplayerSessionMetrics::Get().GetHistogram(ESessionOperation::Find);
+	if (Histogram.GetCount() < static_cast<uint64>(FMath::Max(MinHedgeSamples, 1)) ||
+		Now - Operation.AttemptStartTime < Histogram.GetPercentile(HedgeFindPercentile) / 1000000.0)
+	{
+		return;
+	}
+
+	//One hedge per attempt, whether or not the backend takes it
+	Operation.bHedged = true;
+	Operation.HedgeSearch = MakeShared<FOnlineSessionSearch>(*Operation.Search);
+	Operation.HedgeSearch->SearchResults.Reset();
+	Operation.HedgeSearch->SearchState = EOnlineAsyncTaskState::NotStarted;
+
+	const FUniqueNetIdPtr LocalUserId = GetLocalUserId();
+	const bool bHedgeStarted = LocalUserId.IsValid()
+		? SearchLane.OperationInterface->FindSessions(*LocalUserId, Operation.HedgeSearch.ToSharedRef())
+		: SearchLane.OperationInterface->FindSessions(GetLocalControllerId(), Operation.HedgeSearch.ToSharedRef());
+
+	//NULL and Steam run one search per interface at a time. They log and ignore the hedge but still return true, leaving it NotStarted
+	if (!bHedgeStarted || Operation.HedgeSearch->SearchState != EOnlineAsyncTaskState::InProgress)
+	{
+		Operation.HedgeSearch.Reset();
+		return;
+	}
+	FMultiplayerSessionMetrics::Get().RecordHedge(ESessionOperation::Find);
+}
+
+void UMultiplayerSessionsSubsystem::CompleteOperation(FSessionOperationLane& Lane, bool bWasSuccessful)
+{
+	Lane.bOperationInFlight = false;
+	FMultiplayerSessionMetrics::Get().Record(Lane.CurrentOperation.Type, FPlatformTime::Seconds() - Lane.CurrentOperation.EnqueuedTime, bWasSuccessful);
+
+	//Steps chained behind a failed one would only fail on the backend too
+	if (!bWasSuccessful)
+	{
+		while (Lane.PendingOperations.Num() > 0 && Lane.PendingOperations[0].bRequiresPreviousSuccess)
+		{
+			const FSessionOperation Dropped = MoveTemp(Lane.PendingOperations[0]);
+			Lane.PendingOperations.RemoveAt(0);
+			FMultiplayerSessionMetrics::Get().Record(Dropped.Type, FPlatformTime::Seconds() - Dropped.EnqueuedTime, false);
+			BroadcastOperationFailure(Dropped);
+		}
+	}
+	else if (Lane.PendingOperations.Num() > 0)
+	{
+		Lane.PendingOperations[0].bRequiresPreviousSuccess = false;
+	}
+
+	PumpOperations();
+}
+
+void UMultiplayerSessionsSubsystem::BroadcastOperationFailure(const FSessionOperation& Operation)
+{
+	switch (Operation.Type)
+	{
+	case ESessionOperation::Find:
+		if (IsStreamingPage(Operation))
+		{
+			HandleSearchPage(nullptr, false);
+		}
+
+		if (Operation.bBroadcastResults && FanOutSearch.bActive)
+		{
+			HandleFanOutResult(nullptr, false, false);
+		}
+		else if (Operation.bBroadcastResults)
+		{
+			SessionSummary.Reset();
+			MultiplayerOnFindSessionDelegate.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+			MultiplayerOnFindSessionSummaryDelegate.Broadcast(SessionSummary, true, false);
+		}
+		break;
+
+	case ESessionOperation::Update:
+		if (Operation.SessionName == SessionPool.ClaimingSession)
+		{
+			SessionPool.ClaimingSession = NAME_None;
+			MultiplayerOnCreateSessionDelegate.Broadcast(false);
+		}
+		NotifySessionOperation(Operation.SessionName, Operation.Type, false);
+		break;
+
+	case ESessionOperation::Join:
+		if (Operation.SessionName == NAME_GameSession)
+		{
+			JoinCandidates.Reset();
+			JoinCandidateIndex = INDEX_NONE;
+			MultiplayerOnJoinSessionDelegate.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
+		}
+		NotifySessionOperation(Operation.SessionName, Operation.Type, false);
+		break;
+
+	default:
+		NotifySessionOperation(Operation.SessionName, Operation.Type, false);
+		break;
+	}
+}
+
+
+//Backend Calls
+
+void UMultiplayerSessionsSubsystem::ExecuteCreateSession(FSessionOperationLane& Lane)
+{
+	const FSessionOperation& Operation = Lane.CurrentOperation;
+	const FName SessionName = Operation.SessionName;
+
+	Lane.OperationInterface = SessionInterface;
+	Lane.CompleteDelegateHandle = Lane.OperationInterface->AddOnCreateSessionCompleteDelegate_Handle(
+		FOnCreateSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnCreateSessionComplete, SessionName));
+
+	//Nobody's presence to hang a server session off, and lobbies need a user to own them
+	const bool bDedicated = Operation.bDedicated || IsRunningDedicatedServer();
+
+	TSharedPtr<FOnlineSessionSettings> SessionSettings = MakeShareable(new FOnlineSessionSettings());
+	SessionSettings->bIsLANMatch = IsLanOnlyBackend();
+	SessionSettings->bIsDedicated = bDedicated;
+	SessionSettings->NumPublicConnections = Operation.NumPublicConnections;
+	SessionSettings->bAllowJoinInProgress = true;
+	SessionSettings->bAllowJoinViaPresence = !bDedicated;
+	SessionSettings->bShouldAdvertise = Operation.bAdvertise;
+	SessionSettings->bUsesPresence = !bDedicated;
+	SessionSettings->BuildUniqueId = SessionBuildId;
+	ApplySessionDefaults(Operation.Attributes).WriteTo(*SessionSettings);
+	SessionSettings->bUseLobbiesIfAvailable = !bDedicated;
+
+	FMultiplayerNamedSession& Session = FindOrAddNamedSession(SessionName);
+	Session.Settings = SessionSettings;
+	Session.bIsHost = true;
+
+	//Without a local player HostingPlayerNum 0 has the backend host under the server's own identity
+	const FUniqueNetIdPtr LocalUserId = bDedicated ? nullptr : GetLocalUserId();
+	const bool bIsCreated = LocalUserId.IsValid()
+		? Lane.OperationInterface->CreateSession(*LocalUserId, SessionName, *SessionSettings)
+		: Lane.OperationInterface->CreateSession(0, SessionName, *SessionSettings);
+	if (bIsCreated == false)
+	{
+		//Goes through the completion path so a warm create is retried later
+		OnCreateSessionComplete(SessionName, false, SessionName);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ExecuteFindSessions(FSessionOperationLane& Lane)
+{
+	const FSessionOperation& Operation = Lane.CurrentOperation;
+	Lane.OperationInterface = SessionInterface;
+	Lane.CompleteDelegateHandle = Lane.OperationInterface->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate);
+	LastSessionSearch = Operation.Search;
+	LastSearchKey = Operation.SearchKey;
+	LastSearchFilter = Operation.Attributes;
+	LastSearchStartTime = FPlatformTime::Seconds();
+	bSearchInProgress = true;
+	bBroadcastSearchResults = Operation.bBroadcastResults;
+
+	UE_LOG(LogMultiplayerSessions, Verbose, TEXT("Searching for up to %d sessions on attempt %d"), LastSessionSearch->MaxSearchResults, Operation.Attempt + 1);
+
+	//Local Player To Get Net PLayer Id, headless processes search by controller
+	const FUniqueNetIdPtr LocalUserId = GetLocalUserId();
+	const bool bSearchStarted = LocalUserId.IsValid()
+		? Lane.OperationInterface->FindSessions(*LocalUserId, LastSessionSearch.ToSharedRef())
+		: Lane.OperationInterface->FindSessions(GetLocalControllerId(), LastSessionSearch.ToSharedRef());
+	if (!bSearchStarted)
+	{
+		Lane.OperationInterface->ClearOnFindSessionsCompleteDelegate_Handle(Lane.CompleteDelegateHandle);
+		bSearchInProgress = false;
+
+		FSessionOperation FailedOperation = Operation;
+		FailedOperation.bBroadcastResults = bBroadcastSearchResults;
+		BroadcastOperationFailure(FailedOperation);
+		CompleteOperation(Lane, false);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ExecuteJoinSession(FSessionOperationLane& Lane)
+{
+	const FSessionOperation& Operation = Lane.CurrentOperation;
+	const FName SessionName = Operation.SessionName;
+
+	//Sessions found on LAN only exist on the interface that found them
+	const bool bLanSession = LanSessionInterface.IsValid() && LanSessionIds.Contains(Operation.SearchResult->GetSessionIdStr());
+	Lane.OperationInterface = bLanSession ? LanSessionInterface : SessionInterface;
+
+	//Adding join delegate to interface delegate list
+	Lane.CompleteDelegateHandle = Lane.OperationInterface->AddOnJoinSessionCompleteDelegate_Handle(
+		FOnJoinSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnJoinSessionComplete, SessionName));
+
+	//Local Player To Get Net PLayer Id, the LAN interface has its own ids so it goes by controller like headless processes
+	const FUniqueNetIdPtr LocalUserId = bLanSession ? nullptr : GetLocalUserId();
+	const bool bJoinStarted = LocalUserId.IsValid()
+		? Lane.OperationInterface->JoinSession(*LocalUserId, SessionName, *Operation.SearchResult)
+		: Lane.OperationInterface->JoinSession(GetLocalControllerId(), SessionName, *Operation.SearchResult);
+	if (!bJoinStarted)
+	{
+		//Goes through the completion path so a ranked join can fall back to its next candidate
+		OnJoinSessionComplete(SessionName, EOnJoinSessionCompleteResult::UnknownError, SessionName);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ExecuteDestroySession(FSessionOperationLane& Lane)
+{
+	const FName SessionName = Lane.CurrentOperation.SessionName;
+
+	//The LAN advertisement goes with the session it mirrors
+	if (LanSessionInterface.IsValid() && SessionName == HostedSessionName && LanSessionInterface->GetNamedSession(LanMirrorSessionName))
+	{
+		LanSessionInterface->DestroySession(LanMirrorSessionName);
+	}
+
+	Lane.OperationInterface = GetSessionInterfaceFor(SessionName);
+	Lane.CompleteDelegateHandle = Lane.OperationInterface->AddOnDestroySessionCompleteDelegate_Handle(
+		FOnDestroySessionCompleteDelegate::CreateUObject(this, &ThisClass::OnDestroySessionComplete, SessionName));
+
+	if (!Lane.OperationInterface->DestroySession(SessionName))
+	{
+		Lane.OperationInterface->ClearOnDestroySessionCompleteDelegate_Handle(Lane.CompleteDelegateHandle);
+		NotifySessionOperation(SessionName, ESessionOperation::Destroy, false);
+		CompleteOperation(Lane, false);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ExecuteStartSession(FSessionOperationLane& Lane)
+{
+	const FName SessionName = Lane.CurrentOperation.SessionName;
+
+	Lane.OperationInterface = GetSessionInterfaceFor(SessionName);
+	Lane.CompleteDelegateHandle = Lane.OperationInterface->AddOnStartSessionCompleteDelegate_Handle(
+		FOnStartSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnStartSessionComplete, SessionName));
+
+	bool bSessionStarted = Lane.OperationInterface->StartSession(SessionName);
+	if (!bSessionStarted)
+	{
+		Lane.OperationInterface->ClearOnStartSessionCompleteDelegate_Handle(Lane.CompleteDelegateHandle);
+		NotifySessionOperation(SessionName, ESessionOperation::Start, false);
+		CompleteOperation(Lane, false);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::ExecuteUpdateSession(FSessionOperationLane& Lane)
+{
+	const FSessionOperation& Operation = Lane.CurrentOperation;
+	const FName SessionName = Operation.SessionName;
+
+	Lane.OperationInterface = GetSessionInterfaceFor(SessionName);
+	Lane.CompleteDelegateHandle = Lane.OperationInterface->AddOnUpdateSessionCompleteDelegate_Handle(
+		FOnUpdateSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnUpdateSessionComplete, SessionName));
+
+	//Starts from what the backend holds, joined sessions have no settings of our own
+	FMultiplayerNamedSession& Session = FindOrAddNamedSession(SessionName);
+	const FOnlineSessionSettings* CurrentSettings = Session.Settings.IsValid() ? Session.Settings.Get() : Lane.OperationInterface->GetSessionSettings(SessionName);
+
+	TSharedPtr<FOnlineSessionSettings> SessionSettings = MakeShareable(CurrentSettings ? new FOnlineSessionSettings(*CurrentSettings) : new FOnlineSessionSettings());
+	if (Operation.bPushOccupancy)
+	{
+		//Latest report at the time it goes out, anything reported while this one waited in the lane rides along
+		MultiplayerSessionKeys::PlayerCount.Write(*SessionSettings, Occupancy.NumPlayers);
+		if (Occupancy.ServerLoad != INDEX_NONE)
+		{
+			MultiplayerSessionKeys::ServerLoad.Write(*SessionSettings, Occupancy.ServerLoad);
+		}
+		Occupancy.PushedPlayers = Occupancy.NumPlayers;
+		Occupancy.PushedLoad = Occupancy.ServerLoad;
+	}
+	else
+	{
+		if (Operation.NumPublicConnections > 0)
+		{
+			SessionSettings->NumPublicConnections = Operation.NumPublicConnections;
+		}
+		SessionSettings->bShouldAdvertise = Operation.bAdvertise;
+		ApplySessionDefaults(Operation.Attributes).WriteTo(*SessionSettings);
+	}
+	Session.Settings = SessionSettings;
+
+	if (!Lane.OperationInterface->UpdateSession(SessionName, *SessionSettings, true))
+	{
+		OnUpdateSessionComplete(SessionName, false, SessionName);
+	}
+}
+
+
+//Warm Session Pool
+
+void UMultiplayerSessionsSubsystem::StartSessionPool(int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes, int32 PoolSize)
+{
+	SessionPool.TargetSize = FMath::Max(PoolSize > 0 ? PoolSize : WarmSessionPoolSize, 0);
+	SessionPool.NumPublicConnections = NumPublicConnections;
+	SessionPool.Attributes = Attributes;
+	RefillSessionPool();
+}
+
+void UMultiplayerSessionsSubsystem::StopSessionPool()
+{
+	SessionPool.TargetSize = 0;
+
+	if (PoolRetryTickHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(PoolRetryTickHandle);
+		PoolRetryTickHandle.Reset();
+	}
+
+	const TArray<FName> ReadySessions = MoveTemp(SessionPool.ReadySessions);
+	SessionPool.ReadySessions.Reset();
+	for (const FName& SessionName : ReadySessions)
+	{
+		DestroySession(SessionName);
+	}
+}
+
+bool UMultiplayerSessionsSubsystem::ClaimWarmSession(int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes)
+{
+	if (SessionPool.ReadySessions.Num() == 0 || !SessionInterface.IsValid())
+	{
+		if (IsSessionPoolRunning())
+		{
+			++SessionPool.Stats.Misses;
+		}
+		return false;
+	}
+
+	const FName SessionName = SessionPool.ReadySessions[0];
+	SessionPool.ReadySessions.RemoveAt(0);
+	SessionPool.ClaimingSession = SessionName;
+	HostedSessionName = SessionName;
+	++SessionPool.Stats.Claims;
+
+	UE_LOG(LogMultiplayerSessions, Log, TEXT("Hosting on warm session %s, %d left in the pool"), *SessionName.ToString(), SessionPool.ReadySessions.Num());
+
+	//Listed with the host's settings and started right behind it, the start is dropped if the update fails
+	UpdateSession(SessionName, NumPublicConnections, Attributes, true);
+	if (SessionPool.ClaimingSession == SessionName)
+	{
+		FSessionOperation StartOperation;
+		StartOperation.Type = ESessionOperation::Start;
+		StartOperation.SessionName = SessionName;
+		StartOperation.bRequiresPreviousSuccess = true;
+		EnqueueOperation(MoveTemp(StartOperation));
+	}
+
+	//Refills in its own lane, so it doesn't hold up the claim
+	RefillSessionPool();
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::RefillSessionPool()
+{
+	//Counted up front, creates failing synchronously must not be asked for again in the same call
+	const int32 NumMissing = SessionPool.TargetSize - SessionPool.ReadySessions.Num() - SessionPool.WarmingSessions.Num();
+	for (int32 Index = 0; Index < NumMissing && SessionInterface.IsValid(); ++Index)
+	{
+		const FName SessionName(*FString::Printf(TEXT("WarmSession%d"), SessionPool.NextSessionIndex++));
+		SessionPool.WarmingSessions.Add(SessionName, FPlatformTime::Seconds());
+
+		FSessionOperation Operation;
+		Operation.Type = ESessionOperation::Create;
+		Operation.SessionName = SessionName;
+		Operation.NumPublicConnections = SessionPool.NumPublicConnections;
+		Operation.Attributes = SessionPool.Attributes;
+		Operation.bAdvertise = false;
+		EnqueueOperation(MoveTemp(Operation));
+	}
+}
+
+void UMultiplayerSessionsSubsystem::OnWarmSessionCreated(FName SessionName, bool bWasSuccessful)
+{
+	double RequestedTime = 0.0;
+	if (!SessionPool.WarmingSessions.RemoveAndCopyValue(SessionName, RequestedTime))
+	{
+		return;
+	}
+
+	if (!bWasSuccessful)
+	{
+		++SessionPool.Stats.RefillFailures;
+		if (IsSessionPoolRunning() && !PoolRetryTickHandle.IsValid())
+		{
+			PoolRetryTickHandle = FTSTicker::GetCoreTicker().AddTicker(
+				FTickerDelegate::CreateUObject(this, &ThisClass::TickPoolRetry), FMath::Max(WarmSessionRetrySeconds, 0.0f));
+		}
+		return;
+	}
+
+	//Pool was stopped or shrunk while this one was on the wire
+	if (SessionPool.ReadySessions.Num() >= SessionPool.TargetSize)
+	{
+		DestroySession(SessionName);
+		return;
+	}
+
+	const double Latency = FPlatformTime::Seconds() - RequestedTime;
+	FSessionPoolStats& Stats = SessionPool.Stats;
+	++Stats.Refills;
+	Stats.LastRefillLatency = Latency;
+	Stats.TotalRefillLatency += Latency;
+	Stats.MaxRefillLatency = FMath::Max(Stats.MaxRefillLatency, Latency);
+
+	SessionPool.ReadySessions.Add(SessionName);
+	UE_LOG(LogMultiplayerSessions, Verbose, TEXT("Warm session %s ready after %.0fms, pool %d/%d"),
+		*SessionName.ToString(), Latency * 1000.0, SessionPool.ReadySessions.Num(), SessionPool.TargetSize);
+}
+
+bool UMultiplayerSessionsSubsystem::TickPoolRetry(float DeltaTime)
+{
+	PoolRetryTickHandle.Reset();
+	RefillSessionPool();
+	return false;
+}
+
+void UMultiplayerSessionsSubsystem::DumpSessionPool(FOutputDevice& Ar) const
+{
+	const FSessionPoolStats& Stats = SessionPool.Stats;
+	Ar.Logf(TEXT("Warm session pool: %d/%d ready, %d warming, hosted session %s"),
+		SessionPool.ReadySessions.Num(), SessionPool.TargetSize, SessionPool.WarmingSessions.Num(), *HostedSessionName.ToString());
+	Ar.Logf(TEXT("  claims %d, misses %d, refills %d, refill failures %d"),
+		Stats.Claims, Stats.Misses, Stats.Refills, Stats.RefillFailures);
+	Ar.Logf(TEXT("  refill latency last %.0fms, mean %.0fms, max %.0fms"),
+		Stats.LastRefillLatency * 1000.0, Stats.GetAverageRefillLatency() * 1000.0, Stats.MaxRefillLatency * 1000.0);
+}
+
+void UMultiplayerSessionsSubsystem::OnHostedSessionReady()
+{
+	AdvertiseOnLan();
+
+	//Mock hosts are answered by the mock's own stand-ins
+	if (bAnswerSessionProbes && !ProbeResponder.IsValid() && !IsUsingMockSessionBackend())
+	{
+		//Servers packed onto one machine each get their own -port=
+		int32 GamePort = FURL::UrlConfig.DefaultPort;
+		FParse::Value(FCommandLine::Get(), TEXT("Port="), GamePort);
+
+		ProbeResponder = MakeShared<FSessionPingResponder>();
+		if (!ProbeResponder->Start(GamePort + SessionProbePortOffset))
+		{
+			ProbeResponder.Reset();
+		}
+	}
+
+	//Players who got in before the session was up
+	FlushSessionOccupancy();
+}
+
+
+//Session Occupancy
+
+void UMultiplayerSessionsSubsystem::ReportSessionOccupancy(int32 NumPlayers, int32 ServerLoad)
+{
+	Occupancy.NumPlayers = FMath::Max(NumPlayers, 0);
+	Occupancy.ServerLoad = ServerLoad;
+	FlushSessionOccupancy();
+}
+
+void UMultiplayerSessionsSubsystem::FlushSessionOccupancy()
+{
+	//An armed ticker already sends whatever was reported last
+	if (OccupancyTickHandle.IsValid() || Occupancy.NumPlayers == INDEX_NONE)
+	{
+		return;
+	}
+
+	const bool bPlayersChanged = Occupancy.NumPlayers != Occupancy.PushedPlayers;
+	const bool bLoadChanged = Occupancy.ServerLoad != INDEX_NONE &&
+		(Occupancy.PushedLoad == INDEX_NONE || FMath::Abs(Occupancy.ServerLoad - Occupancy.PushedLoad) >= ServerLoadUpdateThreshold);
+	if (!bPlayersChanged && !bLoadChanged)
+	{
+		return;
+	}
+
+	//Nothing advertised yet, OnHostedSessionReady flushes again once there is
+	IOnlineSessionPtr Interface = GetSessionInterfaceFor(HostedSessionName);
+	if (!Interface.IsValid() || Interface->GetNamedSession(HostedSessionName) == nullptr)
+	{
+		return;
+	}
+
+	//An update still waiting in the lane picks up this report when it goes out
+	const FSessionOperationLane* Lane = FindLane(HostedSessionName);
+	if (Lane && Lane->PendingOperations.ContainsByPredicate([](const FSessionOperation& Pending) { return Pending.bPushOccupancy; }))
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const double Wait = Occupancy.LastPushTime + OccupancyUpdateIntervalSeconds - Now;
+	if (Wait > 0.0)
+	{
+		OccupancyTickHandle = FTSTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateUObject(this, &ThisClass::TickOccupancyUpdate), static_cast<float>(Wait));
+		return;
+	}
+
+	UE_LOG(LogMultiplayerSessions, Verbose, TEXT("Pushing occupancy of %s: %d players, load %d"), *HostedSessionName.ToString(), Occupancy.NumPlayers, Occupancy.ServerLoad);
+
+	FSessionOperation Operation;
+	Operation.Type = ESessionOperation::Update;
+	Operation.SessionName = HostedSessionName;
+	Operation.bPushOccupancy = true;
+	ApplyOperationOptions(Operation, FSessionOperationOptions());
+	Occupancy.LastPushTime = Now;
+	EnqueueOperation(MoveTemp(Operation));
+}
+
+bool UMultiplayerSessionsSubsystem::TickOccupancyUpdate(float DeltaTime)
+{
+	OccupancyTickHandle.Reset();
+	FlushSessionOccupancy();
+	return false;
+}
+
+
+//Delegates CallBack Functions
+
+void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, bool bWasSuccessful, FName LaneName)
+{
+	FSessionOperationLane* Lane = FindLane(LaneName);
+	if (SessionName != LaneName || Lane == nullptr || !Lane->bOperationInFlight)
+	{
+		return;
+	}
+
+	Lane->OperationInterface->ClearOnCreateSessionCompleteDelegate_Handle(Lane->CompleteDelegateHandle);
+	if (!bWasSuccessful && RetryOperation(*Lane))
+	{
+		return;
+	}
+
+	//Warm sessions stay unlisted and unstarted until they are claimed
+	const bool bWarmSession = SessionPool.WarmingSessions.Contains(SessionName);
+
+	//Queued behind this create, so it goes out as soon as the create is done
+	if (bWasSuccessful && !bWarmSession)
+	{
+		StartSession(SessionName);
+	}
+
+	if (bWasSuccessful && SessionName == HostedSessionName)
+	{
+		OnHostedSessionReady();
+	}
+
+	NotifySessionOperation(SessionName, ESessionOperation::Create, bWasSuccessful);
+	if (bWarmSession)
+	{
+		OnWarmSessionCreated(SessionName, bWasSuccessful);
+	}
+	CompleteOperation(*Lane, bWasSuccessful);
+}
+
+void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessful)
+{
+	if (!SearchLane.bOperationInFlight)
+	{
+		return;
+	}
+
+	//Completions don't say which search they are for, the one no longer in progress finished. Late answers to abandoned searches find neither
+	FSessionOperation& Operation = SearchLane.CurrentOperation;
+	const TSharedPtr<FOnlineSessionSearch> Finished =
+		IsSearchFinished(Operation.Search) ? Operation.Search :
+		IsSearchFinished(Operation.HedgeSearch) ? Operation.HedgeSearch : nullptr;
+	if (!Finished.IsValid())
+	{
+		return;
+	}
+
+	const bool bFromHedge = Finished == Operation.HedgeSearch;
+	if (Operation.HedgeSearch.IsValid())
+	{
+		bWasSuccessful = Finished->SearchState == EOnlineAsyncTaskState::Done;
+
+		const TSharedPtr<FOnlineSessionSearch> Other = bFromHedge ? Operation.Search : Operation.HedgeSearch;
+		if (Other->SearchState == EOnlineAsyncTaskState::InProgress)
+		{
+			//The other request may still answer, one of the two failing isn't final
+			if (!bWasSuccessful)
+			{
+				Operation.Search = Other;
+				Operation.HedgeSearch.Reset();
+				return;
+			}
+
+			//First answer wins, the slower request is called off
+			SearchLane.OperationInterface->CancelFindSessions();
+		}
+
+		if (bFromHedge && bWasSuccessful)
+		{
+			FMultiplayerSessionMetrics::Get().RecordHedgeWin(ESessionOperation::Find);
+		}
+	}
+
+	LastSessionSearch = Finished;
+	FinishFindSessions(bWasSuccessful);
+}
+
+void UMultiplayerSessionsSubsystem::FinishFindSessions(bool bWasSuccessful)
+{
+	UE_LOG(LogMultiplayerSessions, Verbose, TEXT("Search %s with %d sessions"), bWasSuccessful ? TEXT("succeeded") : TEXT("failed"), LastSessionSearch->SearchResults.Num());
+
+	SearchLane.OperationInterface->ClearOnFindSessionsCompleteDelegate_Handle(SearchLane.CompleteDelegateHandle);
+
+	bSearchInProgress = false;
+	if (!bWasSuccessful && RetryOperation(SearchLane))
+	{
+		return;
+	}
+
+	if (bWasSuccessful && SearchLane.CurrentOperation.bCacheRefresh)
+	{
+		SearchCache.RecordRefresh(FPlatformTime::Seconds() - LastSearchStartTime);
+	}
+
+	//Backends that ignore QuerySettings (NULL) hand back everything, drop what the filter would have
+	const int32 NumBackendResults = LastSessionSearch->SearchResults.Num();
+	LastSessionSearch->SearchResults.RemoveAll([this](const FOnlineSessionSearchResult& Result)
+	{
+		return !LastSearchFilter.Matches(Result.Session.SessionSettings);
+	});
+
 	if (bWasSuccessful)
 	{
-		MultiplayerOnStartSessionDelegate.Broadcast(true);
+		SearchCache.Store(LastSearchKey, LastSessionSearch, FPlatformTime::Seconds(), NumBackendResults);
+	}
+
+	//Listeners may queue the next search, keep hold of this one until they are done
+	const TSharedPtr<FOnlineSessionSearch> FinishedSearch = LastSessionSearch;
+
+	//Decided before any listener runs, they may start the next streaming search
+	const bool bStreamingPage = IsStreamingPage(SearchLane.CurrentOperation);
+	const bool bBroadcastResults = bBroadcastSearchResults;
+	if (bStreamingPage)
+	{
+		HandleSearchPage(FinishedSearch, bWasSuccessful, NumBackendResults);
+	}
+
+	//Background refresh only updates the cache, callers already got the stale results
+	if (bBroadcastResults)
+	{
+		BroadcastFoundSessions(FinishedSearch, bWasSuccessful);
+	}
+
+	CompleteOperation(SearchLane, bWasSuccessful);
+}
+
+void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result, FName LaneName)
+{
+	FSessionOperationLane* Lane = FindLane(LaneName);
+	if (SessionName != LaneName || Lane == nullptr || !Lane->bOperationInFlight)
+	{
+		return;
+	}
+
+	UE_LOG(LogMultiplayerSessions, Verbose, TEXT("Join of %s completed with result %d"), *SessionName.ToString(), static_cast<int32>(Result));
+
+	Lane->OperationInterface->ClearOnJoinSessionCompleteDelegate_Handle(Lane->CompleteDelegateHandle);
+
+	const bool bWasSuccessful = Result == EOnJoinSessionCompleteResult::Success;
+
+	//Ranked joins with fallback candidates only exist for the game session
+	if (SessionName == NAME_GameSession && JoinCandidates.IsValidIndex(JoinCandidateIndex))
+	{
+		//Full or vanished host, try the next best candidate before telling anyone. A cancelled join stops here
+		const bool bShouldFallBack = !bWasSuccessful && Result != EOnJoinSessionCompleteResult::AlreadyInSession && !Lane->CurrentOperation.IsCancelled();
+		if (bShouldFallBack && JoinCandidates.IsValidIndex(JoinCandidateIndex + 1))
+		{
+			++JoinCandidateIndex;
+			JoinSessions(JoinCandidates[JoinCandidateIndex]);
+			CompleteOperation(*Lane, false);
+			return;
+		}
+
+		JoinCandidates.Reset();
+		JoinCandidateIndex = INDEX_NONE;
+	}
+
+	//Full or vanished hosts won't change their mind, only errors on the way there are worth another attempt
+	const bool bShouldRetry = Result == EOnJoinSessionCompleteResult::UnknownError || Result == EOnJoinSessionCompleteResult::CouldNotRetrieveAddress;
+	if (bShouldRetry && RetryOperation(*Lane))
+	{
+		return;
+	}
+
+	if (SessionName == NAME_GameSession)
+	{
+		MultiplayerOnJoinSessionDelegate.Broadcast(Result);
+	}
+	NotifySessionOperation(SessionName, ESessionOperation::Join, bWasSuccessful);
+	CompleteOperation(*Lane, bWasSuccessful);
+}
+
+void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName, bool bWasSuccessful, FName LaneName)
+{
+	FSessionOperationLane* Lane = FindLane(LaneName);
+	if (SessionName != LaneName || Lane == nullptr || !Lane->bOperationInFlight)
+	{
+		return;
+	}
+
+	Lane->OperationInterface->ClearOnDestroySessionCompleteDelegate_Handle(Lane->CompleteDelegateHandle);
+	if (!bWasSuccessful && RetryOperation(*Lane))
+	{
+		return;
+	}
+
+	if (bWasSuccessful && SessionName == HostedSessionName)
+	{
+		ProbeResponder.Reset();
+	}
+
+	NotifySessionOperation(SessionName, ESessionOperation::Destroy, bWasSuccessful);
+	CompleteOperation(*Lane, bWasSuccessful);
+}
+
+void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessful, FName LaneName)
+{
+	FSessionOperationLane* Lane = FindLane(LaneName);
+	if (SessionName != LaneName || Lane == nullptr || !Lane->bOperationInFlight)
+	{
+		return;
+	}
+
+	Lane->OperationInterface->ClearOnStartSessionCompleteDelegate_Handle(Lane->CompleteDelegateHandle);
+	if (!bWasSuccessful && RetryOperation(*Lane))
+	{
+		return;
+	}
+
+	NotifySessionOperation(SessionName, ESessionOperation::Start, bWasSuccessful);
+	CompleteOperation(*Lane, bWasSuccessful);
+}
+
+void UMultiplayerSessionsSubsystem::OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful, FName LaneName)
+{
+	FSessionOperationLane* Lane = FindLane(LaneName);
+	if (SessionName != LaneName || Lane == nullptr || !Lane->bOperationInFlight)
+	{
+		return;
+	}
+
+	if (Lane->CompleteDelegateHandle.IsValid())
+	{
+		Lane->OperationInterface->ClearOnUpdateSessionCompleteDelegate_Handle(Lane->CompleteDelegateHandle);
+	}
+	if (!bWasSuccessful && RetryOperation(*Lane))
+	{
+		return;
+	}
+
+	//Hosting goes on as if this had been a regular create, a failed claim creates the game session the slow way
+	if (SessionName == SessionPool.ClaimingSession)
+	{
+		SessionPool.ClaimingSession = NAME_None;
+		if (bWasSuccessful)
+		{
+			OnHostedSessionReady();
+			MultiplayerOnCreateSessionDelegate.Broadcast(true);
+		}
+		else
+		{
+			const FSessionOperation& Claim = Lane->CurrentOperation;
+			UE_LOG(LogMultiplayerSessions, Warning, TEXT("Claiming warm session %s failed, creating a new session instead"), *SessionName.ToString());
+			HostedSessionName = NAME_GameSession;
+			DestroySession(SessionName);
+			CreateSession(NAME_GameSession, Claim.NumPublicConnections, Claim.Attributes);
+		}
+	}
+
+	//The backend may still hold the old count, the next flush sends the current one again
+	const bool bOccupancyFailed = !bWasSuccessful && Lane->CurrentOperation.bPushOccupancy;
+	if (bOccupancyFailed)
+	{
+		Occupancy.PushedPlayers = INDEX_NONE;
+		Occupancy.PushedLoad = INDEX_NONE;
+	}
+
+	NotifySessionOperation(SessionName, ESessionOperation::Update, bWasSuccessful);
+	CompleteOperation(*Lane, bWasSuccessful);
+
+	if (bOccupancyFailed)
+	{
+		FlushSessionOccupancy();
 	}
 }
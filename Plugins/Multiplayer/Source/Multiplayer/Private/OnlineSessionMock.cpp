@@ -0,0 +1,773 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "OnlineSessionMock.h"
+#include "Multiplayer.h"
+#include "MultiplayerSessionAttributes.h"
+#include "SessionPingProber.h"
+#include "Containers/Ticker.h"
+#include "OnlineSubsystemTypes.h"
+
+namespace
+{
+	const FName MockNetIdType(TEXT("MOCK"));
+
+	const TCHAR* const MockMatchTypes[] = { TEXT("FreeForAll"), TEXT("TeamDeathmatch"), TEXT("CaptureTheFlag") };
+	const TCHAR* const MockRegions[] = { TEXT(""), TEXT("eu"), TEXT("na"), TEXT("asia") };
+	const TCHAR* const MockMaps[] = { TEXT("Lobby"), TEXT("ThirdPersonMap") };
+
+	bool ToNumber(const FVariantData& Data, double& OutValue)
+	{
+		switch (Data.GetType())
+		{
+		case EOnlineKeyValuePairDataType::Int32: { int32 Value; Data.GetValue(Value); OutValue = Value; return true; }
+		case EOnlineKeyValuePairDataType::Int64: { int64 Value; Data.GetValue(Value); OutValue = static_cast<double>(Value); return true; }
+		case EOnlineKeyValuePairDataType::Float: { float Value; Data.GetValue(Value); OutValue = Value; return true; }
+		case EOnlineKeyValuePairDataType::Double: { Data.GetValue(OutValue); return true; }
+		default: return false;
+		}
+	}
+}
+
+FOnlineSessionInfoMock::FOnlineSessionInfoMock(const FUniqueNetIdRef& InSessionId, const FString& InConnectString)
+	: SessionId(InSessionId)
+	, ConnectString(InConnectString)
+{
+}
+
+FString FOnlineSessionInfoMock::ToDebugString() const
+{
+	return FString::Printf(TEXT("SessionId: %s Address: %s"), *SessionId->ToDebugString(), *ConnectString);
+}
+
+FOnlineSessionMock::FOnlineSessionMock(const FMockSessionBackendSettings& InSettings)
+	: Settings(InSettings)
+	, Random(InSettings.RandomSeed)
+{
+	BuildSyntheticSessions();
+	StartProbeResponders();
+}
+
+FOnlineSessionMock::~FOnlineSessionMock()
+{
+	//Scheduled completions hold a weak pointer and just drop out
+}
+
+void FOnlineSessionMock::SetSettings(const FMockSessionBackendSettings& InSettings)
+{
+	const bool bRebuild = InSettings.NumSyntheticSessions != Settings.NumSyntheticSessions || InSettings.RandomSeed != Settings.RandomSeed;
+	const bool bRestartResponders = bRebuild ||
+		InSettings.bRunProbeResponders != Settings.bRunProbeResponders ||
+		InSettings.HostBasePort != Settings.HostBasePort ||
+		InSettings.NumHostPorts != Settings.NumHostPorts ||
+		InSettings.ProbePortOffset != Settings.ProbePortOffset;
+
+	Settings = InSettings;
+	if (bRebuild)
+	{
+		Random.Initialize(Settings.RandomSeed);
+		BuildSyntheticSessions();
+	}
+	if (bRestartResponders)
+	{
+		StartProbeResponders();
+	}
+}
+
+void FOnlineSessionMock::BuildSyntheticSessions()
+{
+	SyntheticSessions.Reset(Settings.NumSyntheticSessions);
+	SyntheticPings.Reset(Settings.NumSyntheticSessions);
+
+	for (int32 Index = 0; Index < Settings.NumSyntheticSessions; ++Index)
+	{
+		FOnlineSessionSettings SessionSettings;
+		SessionSettings.NumPublicConnections = Random.RandRange(2, 16);
+		SessionSettings.bShouldAdvertise = true;
+		SessionSettings.bUsesPresence = true;
+		SessionSettings.bAllowJoinInProgress = Random.FRand() < 0.8f;
+		SessionSettings.bIsDedicated = Random.FRand() < 0.3f;
+		SessionSettings.BuildUniqueId = 1;
+
+		FMultiplayerSessionAttributes Attributes;
+		Attributes.MatchType = MockMatchTypes[Random.RandHelper(UE_ARRAY_COUNT(MockMatchTypes))];
+		Attributes.Region = MockRegions[Random.RandHelper(UE_ARRAY_COUNT(MockRegions))];
+		Attributes.MapName = MockMaps[Random.RandHelper(UE_ARRAY_COUNT(MockMaps))];
+		Attributes.BuildId = 1;
+		Attributes.SkillBucket = Random.RandRange(0, 9);
+		Attributes.WriteTo(SessionSettings);
+
+		FOnlineSession& Session = SyntheticSessions.Emplace_GetRef(SessionSettings);
+		Session.OwningUserId = FUniqueNetIdString::Create(FString::Printf(TEXT("MockHost%d"), Index), MockNetIdType);
+		Session.OwningUserName = FString::Printf(TEXT("MockHost%d"), Index);
+		Session.NumOpenPublicConnections = Random.RandRange(0, SessionSettings.NumPublicConnections);
+		Session.SessionInfo = MakeShared<FOnlineSessionInfoMock>(MakeSessionId(), MakeConnectString(Index));
+
+		SyntheticPings.Add(Random.RandRange(10, 300));
+	}
+}
+
+void FOnlineSessionMock::Schedule(TFunction<void(FOnlineSessionMock&)>&& Completion)
+{
+	const float DelaySeconds = FMath::Max(0.0f, Settings.LatencyMs + Random.FRandRange(-Settings.JitterMs, Settings.JitterMs)) / 1000.0f;
+	++NumPendingCalls;
+
+	//Never completes inside the call, like a real backend
+	TWeakPtr<FOnlineSessionMock, ESPMode::ThreadSafe> WeakThis = AsShared();
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThis, Completion = MoveTemp(Completion)](float)
+	{
+		if (TSharedPtr<FOnlineSessionMock, ESPMode::ThreadSafe> Mock = WeakThis.Pin())
+		{
+			--Mock->NumPendingCalls;
+			Completion(*Mock);
+		}
+		return false;
+	}), DelaySeconds);
+}
+
+bool FOnlineSessionMock::ShouldFail()
+{
+	return Settings.FailureRate > 0.0f && Random.FRand() < Settings.FailureRate;
+}
+
+bool FOnlineSessionMock::MatchesQuery(const FOnlineSessionSettings& SessionSettings, const FOnlineSearchSettings& QuerySettings)
+{
+	for (const TPair<FName, FOnlineSessionSearchParam>& Param : QuerySettings.SearchParams)
+	{
+		const FOnlineSessionSetting* Setting = SessionSettings.Settings.Find(Param.Key);
+		if (Setting == nullptr)
+		{
+			//Backend level keys (SEARCH_PRESENCE and friends) are not session attributes
+			if (Param.Key == SEARCH_PRESENCE)
+			{
+				if (!SessionSettings.bUsesPresence)
+				{
+					return false;
+				}
+				continue;
+			}
+			return false;
+		}
+
+		double SettingValue = 0.0;
+		double ParamValue = 0.0;
+		const bool bNumeric = ToNumber(Setting->Data, SettingValue) && ToNumber(Param.Value.Data, ParamValue);
+
+		switch (Param.Value.ComparisonOp)
+		{
+		case EOnlineComparisonOp::Equals:
+			if (!(Setting->Data == Param.Value.Data)) return false;
+			break;
+		case EOnlineComparisonOp::NotEquals:
+			if (Setting->Data == Param.Value.Data) return false;
+			break;
+		case EOnlineComparisonOp::GreaterThan:
+			if (bNumeric && !(SettingValue > ParamValue)) return false;
+			break;
+		case EOnlineComparisonOp::GreaterThanEquals:
+			if (bNumeric && !(SettingValue >= ParamValue)) return false;
+			break;
+		case EOnlineComparisonOp::LessThan:
+			if (bNumeric && !(SettingValue < ParamValue)) return false;
+			break;
+		case EOnlineComparisonOp::LessThanEquals:
+			if (bNumeric && !(SettingValue <= ParamValue)) return false;
+			break;
+		default:
+			//Near and In are left to the caller
+			break;
+		}
+	}
+	return true;
+}
+
+FUniqueNetIdRef FOnlineSessionMock::MakeSessionId()
+{
+	return FUniqueNetIdString::Create(FString::Printf(TEXT("MockSession%d"), NextSessionId++), MockNetIdType);
+}
+
+FOnlineSession* FOnlineSessionMock::FindHostSession(const FString& SessionIdStr)
+{
+	//Hosts of synthetic and locally hosted sessions both hand out slots
+	FOnlineSession* Host = SyntheticSessions.FindByPredicate([&SessionIdStr](const FOnlineSession& Candidate)
+	{
+		return Candidate.GetSessionIdStr() == SessionIdStr;
+	});
+	if (Host)
+	{
+		return Host;
+	}
+
+	for (TPair<FName, TUniquePtr<FNamedOnlineSession>>& Pair : NamedSessions)
+	{
+		if (Pair.Value->bHosting && Pair.Value->GetSessionIdStr() == SessionIdStr)
+		{
+			return Pair.Value.Get();
+		}
+	}
+	return nullptr;
+}
+
+void FOnlineSessionMock::StartProbeResponders()
+{
+	ProbeResponders.Reset();
+	if (!Settings.bRunProbeResponders)
+	{
+		return;
+	}
+
+	const bool bLoopbackOnly = Settings.HostAddress == TEXT("127.0.0.1");
+	for (int32 PortIndex = 0; PortIndex < FMath::Max(Settings.NumHostPorts, 1); ++PortIndex)
+	{
+		TSharedPtr<FSessionPingResponder> Responder = MakeShared<FSessionPingResponder>();
+		const int32 ReplyDelayMs = Random.RandRange(5, 250);
+		if (Responder->Start(Settings.HostBasePort + PortIndex + Settings.ProbePortOffset, bLoopbackOnly, ReplyDelayMs))
+		{
+			ProbeResponders.Add(Responder);
+		}
+	}
+
+	UE_LOG(LogMultiplayerSessions, Log, TEXT("Mock session backend answers probes on %d stand-in hosts"), ProbeResponders.Num());
+}
+
+FString FOnlineSessionMock::MakeConnectString(int32 PortOffset) const
+{
+	return FString::Printf(TEXT("%s:%d"), *Settings.HostAddress, Settings.HostBasePort + PortOffset % FMath::Max(Settings.NumHostPorts, 1));
+}
+
+
+//Named Sessions
+
+FUniqueNetIdPtr FOnlineSessionMock::CreateSessionIdFromString(const FString& SessionIdStr)
+{
+	return FUniqueNetIdString::Create(SessionIdStr, MockNetIdType);
+}
+
+FNamedOnlineSession* FOnlineSessionMock::AddNamedSession(FName SessionName, const FOnlineSessionSettings& SessionSettings)
+{
+	return NamedSessions.Emplace(SessionName, MakeUnique<FNamedOnlineSession>(SessionName, SessionSettings)).Get();
+}
+
+FNamedOnlineSession* FOnlineSessionMock::AddNamedSession(FName SessionName, const FOnlineSession& Session)
+{
+	return NamedSessions.Emplace(SessionName, MakeUnique<FNamedOnlineSession>(SessionName, Session)).Get();
+}
+
+FNamedOnlineSession* FOnlineSessionMock::GetNamedSession(FName SessionName)
+{
+	TUniquePtr<FNamedOnlineSession>* Session = NamedSessions.Find(SessionName);
+	return Session ? Session->Get() : nullptr;
+}
+
+void FOnlineSessionMock::RemoveNamedSession(FName SessionName)
+{
+	NamedSessions.Remove(SessionName);
+}
+
+bool FOnlineSessionMock::HasPresenceSession()
+{
+	for (const TPair<FName, TUniquePtr<FNamedOnlineSession>>& Pair : NamedSessions)
+	{
+		if (Pair.Value->SessionSettings.bUsesPresence)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+EOnlineSessionState::Type FOnlineSessionMock::GetSessionState(FName SessionName) const
+{
+	const TUniquePtr<FNamedOnlineSession>* Session = NamedSessions.Find(SessionName);
+	return Session ? (*Session)->SessionState : EOnlineSessionState::NoSession;
+}
+
+FOnlineSessionSettings* FOnlineSessionMock::GetSessionSettings(FName SessionName)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	return Session ? &Session->SessionSettings : nullptr;
+}
+
+int32 FOnlineSessionMock::GetNumSessions()
+{
+	return NamedSessions.Num();
+}
+
+void FOnlineSessionMock::DumpSessionState()
+{
+	UE_LOG(LogMultiplayerSessions, Log, TEXT("Mock session backend: %d synthetic sessions, %d named sessions, %d pending calls"), SyntheticSessions.Num(), NamedSessions.Num(), NumPendingCalls);
+	for (const TPair<FName, TUniquePtr<FNamedOnlineSession>>& Pair : NamedSessions)
+	{
+		UE_LOG(LogMultiplayerSessions, Log, TEXT("  %s state=%s hosting=%d players=%d open=%d"),
+			*Pair.Key.ToString(),
+			EOnlineSessionState::ToString(Pair.Value->SessionState),
+			Pair.Value->bHosting,
+			Pair.Value->RegisteredPlayers.Num(),
+			Pair.Value->NumOpenPublicConnections);
+	}
+}
+
+
+//Session Lifetime
+
+bool FOnlineSessionMock::CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	return CreateSession(*FUniqueNetIdString::Create(FString::Printf(TEXT("MockLocalPlayer%d"), HostingPlayerNum), MockNetIdType), SessionName, NewSessionSettings);
+}
+
+bool FOnlineSessionMock::CreateSession(const FUniqueNetId& HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	if (GetNamedSession(SessionName))
+	{
+		UE_LOG(LogMultiplayerSessions, Warning, TEXT("Mock CreateSession: session %s already exists"), *SessionName.ToString());
+		return false;
+	}
+
+	FNamedOnlineSession* Session = AddNamedSession(SessionName, NewSessionSettings);
+	Session->SessionState = EOnlineSessionState::Creating;
+	Session->bHosting = true;
+	Session->OwningUserId = HostingPlayerId.AsShared();
+	Session->OwningUserName = HostingPlayerId.ToString();
+	Session->NumOpenPublicConnections = NewSessionSettings.NumPublicConnections;
+	Session->NumOpenPrivateConnections = NewSessionSettings.NumPrivateConnections;
+	Session->SessionInfo = MakeShared<FOnlineSessionInfoMock>(MakeSessionId(), MakeConnectString(0));
+
+	const bool bFail = ShouldFail();
+	Schedule([SessionName, bFail](FOnlineSessionMock& Mock)
+	{
+		FNamedOnlineSession* Created = Mock.GetNamedSession(SessionName);
+		const bool bWasSuccessful = !bFail && Created != nullptr;
+		if (bWasSuccessful)
+		{
+			Created->SessionState = EOnlineSessionState::Pending;
+		}
+		else
+		{
+			Mock.RemoveNamedSession(SessionName);
+		}
+		Mock.TriggerOnCreateSessionCompleteDelegates(SessionName, bWasSuccessful);
+	});
+	return true;
+}
+
+bool FOnlineSessionMock::StartSession(FName SessionName)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session == nullptr || (Session->SessionState != EOnlineSessionState::Pending && Session->SessionState != EOnlineSessionState::Ended))
+	{
+		return false;
+	}
+
+	Session->SessionState = EOnlineSessionState::Starting;
+	const bool bFail = ShouldFail();
+	Schedule([SessionName, bFail](FOnlineSessionMock& Mock)
+	{
+		FNamedOnlineSession* Started = Mock.GetNamedSession(SessionName);
+		const bool bWasSuccessful = !bFail && Started != nullptr;
+		if (Started)
+		{
+			Started->SessionState = bWasSuccessful ? EOnlineSessionState::InProgress : EOnlineSessionState::Pending;
+		}
+		Mock.TriggerOnStartSessionCompleteDelegates(SessionName, bWasSuccessful);
+	});
+	return true;
+}
+
+bool FOnlineSessionMock::UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session == nullptr)
+	{
+		return false;
+	}
+
+	const bool bFail = ShouldFail();
+	Schedule([SessionName, UpdatedSessionSettings, bFail](FOnlineSessionMock& Mock)
+	{
+		FNamedOnlineSession* Updated = Mock.GetNamedSession(SessionName);
+		const bool bWasSuccessful = !bFail && Updated != nullptr;
+		if (bWasSuccessful)
+		{
+			Updated->SessionSettings = UpdatedSessionSettings;
+		}
+		Mock.TriggerOnUpdateSessionCompleteDelegates(SessionName, bWasSuccessful);
+	});
+	return true;
+}
+
+bool FOnlineSessionMock::EndSession(FName SessionName)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session == nullptr || Session->SessionState != EOnlineSessionState::InProgress)
+	{
+		return false;
+	}
+
+	Session->SessionState = EOnlineSessionState::Ending;
+	Schedule([SessionName](FOnlineSessionMock& Mock)
+	{
+		FNamedOnlineSession* Ended = Mock.GetNamedSession(SessionName);
+		if (Ended)
+		{
+			Ended->SessionState = EOnlineSessionState::Ended;
+		}
+		Mock.TriggerOnEndSessionCompleteDelegates(SessionName, Ended != nullptr);
+	});
+	return true;
+}
+
+bool FOnlineSessionMock::DestroySession(FName SessionName, const FOnDestroySessionCompleteDelegate& CompletionDelegate)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session == nullptr || Session->SessionState == EOnlineSessionState::Destroying)
+	{
+		return false;
+	}
+
+	const EOnlineSessionState::Type PreviousState = Session->SessionState;
+	Session->SessionState = EOnlineSessionState::Destroying;
+
+	const bool bFail = ShouldFail();
+	Schedule([SessionName, CompletionDelegate, PreviousState, bFail](FOnlineSessionMock& Mock)
+	{
+		FNamedOnlineSession* Destroyed = Mock.GetNamedSession(SessionName);
+		const bool bWasSuccessful = !bFail && Destroyed != nullptr;
+		if (bWasSuccessful)
+		{
+			//Leaving hands the slot back to the host
+			if (!Destroyed->bHosting)
+			{
+				if (FOnlineSession* Host = Mock.FindHostSession(Destroyed->GetSessionIdStr()))
+				{
+					Host->NumOpenPublicConnections = FMath::Min(Host->NumOpenPublicConnections + 1, Host->SessionSettings.NumPublicConnections);
+				}
+			}
+			Mock.RemoveNamedSession(SessionName);
+		}
+		else if (Destroyed)
+		{
+			Destroyed->SessionState = PreviousState;
+		}
+		CompletionDelegate.ExecuteIfBound(SessionName, bWasSuccessful);
+		Mock.TriggerOnDestroySessionCompleteDelegates(SessionName, bWasSuccessful);
+	});
+	return true;
+}
+
+
+//Searching
+
+bool FOnlineSessionMock::FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	//Real backends ignore a second search on the same interface, the mock answers every one so overlap can be measured
+	SearchSettings->SearchState = EOnlineAsyncTaskState::InProgress;
+	SearchSettings->SearchResults.Reset();
+	PendingSearches.Add(SearchSettings);
+
+	const bool bFail = ShouldFail();
+	Schedule([SearchSettings, bFail](FOnlineSessionMock& Mock)
+	{
+		//Cancelled while on the wire
+		if (Mock.PendingSearches.Remove(SearchSettings) == 0)
+		{
+			return;
+		}
+
+		if (bFail)
+		{
+			SearchSettings->SearchState = EOnlineAsyncTaskState::Failed;
+			Mock.TriggerOnFindSessionsCompleteDelegates(false);
+			return;
+		}
+
+		const int32 MaxResults = SearchSettings->MaxSearchResults > 0 ? SearchSettings->MaxSearchResults : MAX_int32;
+		for (int32 Index = 0; Index < Mock.SyntheticSessions.Num() && SearchSettings->SearchResults.Num() < MaxResults; ++Index)
+		{
+			const FOnlineSession& Session = Mock.SyntheticSessions[Index];
+			if (MatchesQuery(Session.SessionSettings, SearchSettings->QuerySettings))
+			{
+				FOnlineSessionSearchResult& Result = SearchSettings->SearchResults.AddDefaulted_GetRef();
+				Result.Session = Session;
+				Result.PingInMs = Mock.SyntheticPings[Index];
+			}
+		}
+
+		//Sessions hosted in this process show up too, so a single process can create, find and join
+		for (const TPair<FName, TUniquePtr<FNamedOnlineSession>>& Pair : Mock.NamedSessions)
+		{
+			const FNamedOnlineSession& Session = *Pair.Value;
+			if (SearchSettings->SearchResults.Num() >= MaxResults)
+			{
+				break;
+			}
+			if (Session.bHosting && Session.SessionSettings.bShouldAdvertise && Session.SessionState != EOnlineSessionState::Creating && MatchesQuery(Session.SessionSettings, SearchSettings->QuerySettings))
+			{
+				FOnlineSessionSearchResult& Result = SearchSettings->SearchResults.AddDefaulted_GetRef();
+				Result.Session = Session;
+				Result.PingInMs = 0;
+			}
+		}
+
+		SearchSettings->SearchState = EOnlineAsyncTaskState::Done;
+		Mock.TriggerOnFindSessionsCompleteDelegates(true);
+	});
+	return true;
+}
+
+bool FOnlineSessionMock::FindSessions(const FUniqueNetId& SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return FindSessions(0, SearchSettings);
+}
+
+bool FOnlineSessionMock::FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId, const FUniqueNetId& FriendId, const FOnSingleSessionResultCompleteDelegate& CompletionDelegate)
+{
+	const FString SessionIdStr = SessionId.ToString();
+	Schedule([SessionIdStr, CompletionDelegate](FOnlineSessionMock& Mock)
+	{
+		FOnlineSessionSearchResult Result;
+		bool bFound = false;
+		for (int32 Index = 0; Index < Mock.SyntheticSessions.Num(); ++Index)
+		{
+			if (Mock.SyntheticSessions[Index].GetSessionIdStr() == SessionIdStr)
+			{
+				Result.Session = Mock.SyntheticSessions[Index];
+				Result.PingInMs = Mock.SyntheticPings[Index];
+				bFound = true;
+				break;
+			}
+		}
+		CompletionDelegate.ExecuteIfBound(0, bFound, Result);
+	});
+	return true;
+}
+
+bool FOnlineSessionMock::CancelFindSessions()
+{
+	if (PendingSearches.Num() == 0)
+	{
+		return false;
+	}
+
+	for (const TSharedRef<FOnlineSessionSearch>& Search : PendingSearches)
+	{
+		Search->SearchState = EOnlineAsyncTaskState::Failed;
+	}
+	PendingSearches.Reset();
+
+	Schedule([](FOnlineSessionMock& Mock)
+	{
+		Mock.TriggerOnCancelFindSessionsCompleteDelegates(true);
+	});
+	return true;
+}
+
+bool FOnlineSessionMock::PingSearchResults(const FOnlineSessionSearchResult& SearchResult)
+{
+	return false;
+}
+
+bool FOnlineSessionMock::StartMatchmaking(const TArray<FUniqueNetIdRef>& LocalPlayers, FName SessionName, const FOnlineSessionSettings& NewSessionSettings, TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	UE_LOG(LogMultiplayerSessions, Warning, TEXT("Mock session backend does not support matchmaking"));
+	return false;
+}
+
+bool FOnlineSessionMock::CancelMatchmaking(int32 SearchingPlayerNum, FName SessionName)
+{
+	return false;
+}
+
+bool FOnlineSessionMock::CancelMatchmaking(const FUniqueNetId& SearchingPlayerId, FName SessionName)
+{
+	return false;
+}
+
+
+//Joining
+
+bool FOnlineSessionMock::JoinSession(int32 LocalUserNum, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	if (GetNamedSession(SessionName))
+	{
+		Schedule([SessionName](FOnlineSessionMock& Mock)
+		{
+			Mock.TriggerOnJoinSessionCompleteDelegates(SessionName, EOnJoinSessionCompleteResult::AlreadyInSession);
+		});
+		return true;
+	}
+
+	FNamedOnlineSession* Session = AddNamedSession(SessionName, DesiredSession.Session);
+	Session->SessionState = EOnlineSessionState::Pending;
+	Session->bHosting = false;
+
+	const FString SessionIdStr = DesiredSession.GetSessionIdStr();
+	const bool bFail = ShouldFail();
+	Schedule([SessionName, SessionIdStr, bFail](FOnlineSessionMock& Mock)
+	{
+		EOnJoinSessionCompleteResult::Type Result = bFail ? EOnJoinSessionCompleteResult::UnknownError : EOnJoinSessionCompleteResult::SessionDoesNotExist;
+
+		if (!bFail)
+		{
+			FOnlineSession* Host = Mock.FindHostSession(SessionIdStr);
+			if (Host && Host->NumOpenPublicConnections <= 0)
+			{
+				Result = EOnJoinSessionCompleteResult::SessionIsFull;
+			}
+			else if (Host)
+			{
+				--Host->NumOpenPublicConnections;
+				Result = EOnJoinSessionCompleteResult::Success;
+			}
+		}
+
+		if (Result != EOnJoinSessionCompleteResult::Success)
+		{
+			Mock.RemoveNamedSession(SessionName);
+		}
+		Mock.TriggerOnJoinSessionCompleteDelegates(SessionName, Result);
+	});
+	return true;
+}
+
+bool FOnlineSessionMock::JoinSession(const FUniqueNetId& LocalUserId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	return JoinSession(0, SessionName, DesiredSession);
+}
+
+bool FOnlineSessionMock::FindFriendSession(int32 LocalUserNum, const FUniqueNetId& Friend)
+{
+	TriggerOnFindFriendSessionCompleteDelegates(LocalUserNum, false, TArray<FOnlineSessionSearchResult>());
+	return false;
+}
+
+bool FOnlineSessionMock::FindFriendSession(const FUniqueNetId& LocalUserId, const FUniqueNetId& Friend)
+{
+	return FindFriendSession(0, Friend);
+}
+
+bool FOnlineSessionMock::FindFriendSession(const FUniqueNetId& LocalUserId, const TArray<FUniqueNetIdRef>& FriendList)
+{
+	TriggerOnFindFriendSessionCompleteDelegates(0, false, TArray<FOnlineSessionSearchResult>());
+	return false;
+}
+
+bool FOnlineSessionMock::SendSessionInviteToFriend(int32 LocalUserNum, FName SessionName, const FUniqueNetId& Friend)
+{
+	return false;
+}
+
+bool FOnlineSessionMock::SendSessionInviteToFriend(const FUniqueNetId& LocalUserId, FName SessionName, const FUniqueNetId& Friend)
+{
+	return false;
+}
+
+bool FOnlineSessionMock::SendSessionInviteToFriends(int32 LocalUserNum, FName SessionName, const TArray<FUniqueNetIdRef>& Friends)
+{
+	return false;
+}
+
+bool FOnlineSessionMock::SendSessionInviteToFriends(const FUniqueNetId& LocalUserId, FName SessionName, const TArray<FUniqueNetIdRef>& Friends)
+{
+	return false;
+}
+
+bool FOnlineSessionMock::GetResolvedConnectString(FName SessionName, FString& ConnectInfo, FName PortType)
+{
+	const FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session == nullptr || !Session->SessionInfo.IsValid())
+	{
+		return false;
+	}
+
+	ConnectInfo = StaticCastSharedPtr<FOnlineSessionInfoMock>(Session->SessionInfo)->GetConnectString();
+	return true;
+}
+
+bool FOnlineSessionMock::GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo)
+{
+	if (!SearchResult.Session.SessionInfo.IsValid())
+	{
+		return false;
+	}
+
+	ConnectInfo = StaticCastSharedPtr<FOnlineSessionInfoMock>(SearchResult.Session.SessionInfo)->GetConnectString();
+	return true;
+}
+
+
+//Players
+
+bool FOnlineSessionMock::IsPlayerInSession(FName SessionName, const FUniqueNetId& UniqueId)
+{
+	const FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	return Session && Session->RegisteredPlayers.ContainsByPredicate([&UniqueId](const FUniqueNetIdRef& PlayerId)
+	{
+		return *PlayerId == UniqueId;
+	});
+}
+
+bool FOnlineSessionMock::RegisterPlayer(FName SessionName, const FUniqueNetId& PlayerId, bool bWasInvited)
+{
+	TArray<FUniqueNetIdRef> Players;
+	Players.Add(PlayerId.AsShared());
+	return RegisterPlayers(SessionName, Players, bWasInvited);
+}
+
+bool FOnlineSessionMock::RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasInvited)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session)
+	{
+		for (const FUniqueNetIdRef& PlayerId : Players)
+		{
+			if (!IsPlayerInSession(SessionName, *PlayerId))
+			{
+				Session->RegisteredPlayers.Add(PlayerId);
+				Session->NumOpenPublicConnections = FMath::Max(Session->NumOpenPublicConnections - 1, 0);
+			}
+		}
+	}
+
+	TriggerOnRegisterPlayersCompleteDelegates(SessionName, Players, Session != nullptr);
+	return Session != nullptr;
+}
+
+bool FOnlineSessionMock::UnregisterPlayer(FName SessionName, const FUniqueNetId& PlayerId)
+{
+	TArray<FUniqueNetIdRef> Players;
+	Players.Add(PlayerId.AsShared());
+	return UnregisterPlayers(SessionName, Players);
+}
+
+bool FOnlineSessionMock::UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session)
+	{
+		for (const FUniqueNetIdRef& PlayerId : Players)
+		{
+			const int32 NumRemoved = Session->RegisteredPlayers.RemoveAll([&PlayerId](const FUniqueNetIdRef& Registered)
+			{
+				return *Registered == *PlayerId;
+			});
+			Session->NumOpenPublicConnections = FMath::Min(Session->NumOpenPublicConnections + NumRemoved, Session->SessionSettings.NumPublicConnections);
+		}
+	}
+
+	TriggerOnUnregisterPlayersCompleteDelegates(SessionName, Players, Session != nullptr);
+	return Session != nullptr;
+}
+
+void FOnlineSessionMock::RegisterLocalPlayer(const FUniqueNetId& PlayerId, FName SessionName, const FOnRegisterLocalPlayerCompleteDelegate& Delegate)
+{
+	Delegate.ExecuteIfBound(PlayerId, EOnJoinSessionCompleteResult::Success);
+}
+
+void FOnlineSessionMock::UnregisterLocalPlayer(const FUniqueNetId& PlayerId, FName SessionName, const FOnUnregisterLocalPlayerCompleteDelegate& Delegate)
+{
+	Delegate.ExecuteIfBound(PlayerId, true);
+}
+
+void FOnlineSessionMock::RemovePlayerFromSession(int32 LocalUserNum, FName SessionName, const FUniqueNetId& TargetPlayerId)
+{
+	UnregisterPlayer(SessionName, TargetPlayerId);
+}
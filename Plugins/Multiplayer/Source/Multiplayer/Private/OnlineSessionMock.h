@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "OnlineSessionSettings.h"
+#include "Math/RandomStream.h"
+
+class FSessionPingResponder;
+
+/**
+ * Knobs for the in-process session backend
+ */
+struct FMockSessionBackendSettings
+{
+	//Synthetic sessions every search runs against
+	int32 NumSyntheticSessions = 2000;
+
+	//Every backend call completes after Latency +/- Jitter
+	float LatencyMs = 80.0f;
+	float JitterMs = 40.0f;
+
+	//Chance (0..1) that a call fails instead of completing
+	float FailureRate = 0.0f;
+
+	int32 RandomSeed = 0;
+
+	//Synthetic hosts resolve to this address, port is offset by the session index
+	FString HostAddress = TEXT("127.0.0.1");
+	int32 HostBasePort = 7777;
+	int32 NumHostPorts = 1;
+
+	//Loopback stand-ins answer ping probes for every host port, each with its own fixed delay
+	bool bRunProbeResponders = false;
+	int32 ProbePortOffset = 100;
+};
+
+/**
+ * Session info of a mock session, only carries an id and an address
+ */
+class FOnlineSessionInfoMock : public FOnlineSessionInfo
+{
+public:
+
+	FOnlineSessionInfoMock(const FUniqueNetIdRef& InSessionId, const FString& InConnectString);
+
+	virtual const uint8* GetBytes() const override { return nullptr; }
+	virtual int32 GetSize() const override { return sizeof(FOnlineSessionInfoMock); }
+	virtual bool IsValid() const override { return SessionId->IsValid(); }
+	virtual FString ToString() const override { return SessionId->ToString(); }
+	virtual FString ToDebugString() const override;
+	virtual const FUniqueNetId& GetSessionId() const override { return *SessionId; }
+
+	const FString& GetConnectString() const { return ConnectString; }
+
+private:
+
+	FUniqueNetIdRef SessionId;
+	FString ConnectString;
+};
+
+/**
+ * In-process stand-in for a platform session interface.
+ * Holds thousands of synthetic sessions in memory, honours QuerySettings equality filters and completes every call
+ * on the core ticker after a configurable latency, so the subsystem can be profiled without Steam or a network.
+ */
+class FOnlineSessionMock : public IOnlineSession, public TSharedFromThis<FOnlineSessionMock, ESPMode::ThreadSafe>
+{
+public:
+
+	explicit FOnlineSessionMock(const FMockSessionBackendSettings& InSettings);
+	virtual ~FOnlineSessionMock();
+
+	const FMockSessionBackendSettings& GetSettings() const { return Settings; }
+	void SetSettings(const FMockSessionBackendSettings& InSettings);
+
+	//Number of backend calls whose completion has not fired yet
+	int32 GetNumPendingCalls() const { return NumPendingCalls; }
+
+	//IOnlineSession
+	virtual FUniqueNetIdPtr CreateSessionIdFromString(const FString& SessionIdStr) override;
+	virtual FNamedOnlineSession* GetNamedSession(FName SessionName) override;
+	virtual void RemoveNamedSession(FName SessionName) override;
+	virtual bool HasPresenceSession() override;
+	virtual EOnlineSessionState::Type GetSessionState(FName SessionName) const override;
+	virtual bool CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) override;
+	virtual bool CreateSession(const FUniqueNetId& HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) override;
+	virtual bool StartSession(FName SessionName) override;
+	virtual bool UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData = true) override;
+	virtual bool EndSession(FName SessionName) override;
+	virtual bool DestroySession(FName SessionName, const FOnDestroySessionCompleteDelegate& CompletionDelegate = FOnDestroySessionCompleteDelegate()) override;
+	virtual bool IsPlayerInSession(FName SessionName, const FUniqueNetId& UniqueId) override;
+	virtual bool StartMatchmaking(const TArray<FUniqueNetIdRef>& LocalPlayers, FName SessionName, const FOnlineSessionSettings& NewSessionSettings, TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool CancelMatchmaking(int32 SearchingPlayerNum, FName SessionName) override;
+	virtual bool CancelMatchmaking(const FUniqueNetId& SearchingPlayerId, FName SessionName) override;
+	virtual bool FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool FindSessions(const FUniqueNetId& SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId, const FUniqueNetId& FriendId, const FOnSingleSessionResultCompleteDelegate& CompletionDelegate) override;
+	virtual bool CancelFindSessions() override;
+	virtual bool PingSearchResults(const FOnlineSessionSearchResult& SearchResult) override;
+	virtual bool JoinSession(int32 LocalUserNum, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) override;
+	virtual bool JoinSession(const FUniqueNetId& LocalUserId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) override;
+	virtual bool FindFriendSession(int32 LocalUserNum, const FUniqueNetId& Friend) override;
+	virtual bool FindFriendSession(const FUniqueNetId& LocalUserId, const FUniqueNetId& Friend) override;
+	virtual bool FindFriendSession(const FUniqueNetId& LocalUserId, const TArray<FUniqueNetIdRef>& FriendList) override;
+	virtual bool SendSessionInviteToFriend(int32 LocalUserNum, FName SessionName, const FUniqueNetId& Friend) override;
+	virtual bool SendSessionInviteToFriend(const FUniqueNetId& LocalUserId, FName SessionName, const FUniqueNetId& Friend) override;
+	virtual bool SendSessionInviteToFriends(int32 LocalUserNum, FName SessionName, const TArray<FUniqueNetIdRef>& Friends) override;
+	virtual bool SendSessionInviteToFriends(const FUniqueNetId& LocalUserId, FName SessionName, const TArray<FUniqueNetIdRef>& Friends) override;
+	virtual bool GetResolvedConnectString(FName SessionName, FString& ConnectInfo, FName PortType = NAME_GamePort) override;
+	virtual bool GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo) override;
+	virtual FOnlineSessionSettings* GetSessionSettings(FName SessionName) override;
+	virtual bool RegisterPlayer(FName SessionName, const FUniqueNetId& PlayerId, bool bWasInvited) override;
+	virtual bool RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasInvited = false) override;
+	virtual bool UnregisterPlayer(FName SessionName, const FUniqueNetId& PlayerId) override;
+	virtual bool UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players) override;
+	virtual void RegisterLocalPlayer(const FUniqueNetId& PlayerId, FName SessionName, const FOnRegisterLocalPlayerCompleteDelegate& Delegate) override;
+	virtual void UnregisterLocalPlayer(const FUniqueNetId& PlayerId, FName SessionName, const FOnUnregisterLocalPlayerCompleteDelegate& Delegate) override;
+	virtual void RemovePlayerFromSession(int32 LocalUserNum, FName SessionName, const FUniqueNetId& TargetPlayerId) override;
+	virtual int32 GetNumSessions() override;
+	virtual void DumpSessionState() override;
+
+protected:
+
+	virtual FNamedOnlineSession* AddNamedSession(FName SessionName, const FOnlineSessionSettings& SessionSettings) override;
+	virtual FNamedOnlineSession* AddNamedSession(FName SessionName, const FOnlineSession& Session) override;
+
+private:
+
+	void BuildSyntheticSessions();
+	void StartProbeResponders();
+
+	//Runs Completion on the game thread after the configured latency
+	void Schedule(TFunction<void(FOnlineSessionMock&)>&& Completion);
+	bool ShouldFail();
+
+	static bool MatchesQuery(const FOnlineSessionSettings& SessionSettings, const FOnlineSearchSettings& QuerySettings);
+	FOnlineSession* FindHostSession(const FString& SessionIdStr);
+	FUniqueNetIdRef MakeSessionId();
+	FString MakeConnectString(int32 PortOffset) const;
+
+	FMockSessionBackendSettings Settings;
+	FRandomStream Random;
+	int32 NextSessionId = 0;
+	int32 NumPendingCalls = 0;
+
+	//Advertised sessions searches run against
+	TArray<FOnlineSession> SyntheticSessions;
+	TArray<int32> SyntheticPings;
+
+	//Sessions this process created or joined
+	TMap<FName, TUniquePtr<FNamedOnlineSession>> NamedSessions;
+
+	//Searches still waiting for their completion, cancelling drops them
+	TArray<TSharedRef<FOnlineSessionSearch>> PendingSearches;
+
+	//Measured pings deliberately disagree with SyntheticPings, like a backend with coarse ping data
+	TArray<TSharedPtr<FSessionPingResponder>> ProbeResponders;
+};
@@ -0,0 +1,314 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionChurnBenchmark.h"
+#include "Multiplayer.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "MultiplayerSessionMetrics.h"
+#include "OnlineSessionSettings.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	TWeakObjectPtr<USessionChurnBenchmark> ActiveBenchmark;
+
+	constexpr int32 BenchmarkSearchResults = 100;
+
+	double ToMegabytes(uint64 Bytes)
+	{
+		return Bytes / (1024.0 * 1024.0);
+	}
+
+	FMultiplayerSessionAttributes MakeBenchmarkAttributes()
+	{
+		FMultiplayerSessionAttributes Attributes;
+		Attributes.MatchType = TEXT("FreeForAll");
+		return Attributes;
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs SessionChurnCommand(
+		TEXT("Multiplayer.Bench.SessionChurn"),
+		TEXT("Runs create/start/find/join/destroy cycles and writes a JSON report. Cycles=N (default 1000), Output=Dir (default Saved/Profiling/MultiplayerSessions), Exit quits when done"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+			UMultiplayerSessionsSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr;
+			if (Subsystem == nullptr)
+			{
+				UE_LOG(LogMultiplayerSessions, Warning, TEXT("Session churn benchmark needs a game instance with the sessions subsystem"));
+				return;
+			}
+
+			const FString Joined = FString::Join(Args, TEXT(" "));
+			int32 NumCycles = 1000;
+			FString OutputDirectory = FPaths::ProfilingDir() / TEXT("MultiplayerSessions");
+			FParse::Value(*Joined, TEXT("Cycles="), NumCycles);
+			FParse::Value(*Joined, TEXT("Output="), OutputDirectory);
+
+			USessionChurnBenchmark::Run(Subsystem, FMath::Max(NumCycles, 1), OutputDirectory, Args.Contains(TEXT("Exit")));
+		}));
+}
+
+USessionChurnBenchmark* USessionChurnBenchmark::Run(UMultiplayerSessionsSubsystem* InSubsystem, int32 InNumCycles, const FString& InOutputDirectory, bool bInExitWhenDone)
+{
+	if (ActiveBenchmark.IsValid())
+	{
+		UE_LOG(LogMultiplayerSessions, Warning, TEXT("Session churn benchmark is already running"));
+		return nullptr;
+	}
+
+	USessionChurnBenchmark* Benchmark = NewObject<USessionChurnBenchmark>(GetTransientPackage());
+	Benchmark->AddToRoot();
+	Benchmark->Subsystem = InSubsystem;
+	Benchmark->NumCycles = InNumCycles;
+	Benchmark->OutputDirectory = InOutputDirectory;
+	Benchmark->bExitWhenDone = bInExitWhenDone;
+	ActiveBenchmark = Benchmark;
+
+	Benchmark->Begin();
+	return Benchmark;
+}
+
+void USessionChurnBenchmark::Begin()
+{
+	Subsystem->MultiplayerOnCreateSessionDelegate.AddDynamic(this, &ThisClass::OnCreateSession);
+	Subsystem->MultiplayerOnStartSessionDelegate.AddDynamic(this, &ThisClass::OnStartSession);
+	Subsystem->MultiplayerOnDestroySessionDelegate.AddDynamic(this, &ThisClass::OnDestroySession);
+	FindSessionHandle = Subsystem->MultiplayerOnFindSessionDelegate.AddUObject(this, &ThisClass::OnFindSession);
+	JoinSessionHandle = Subsystem->MultiplayerOnJoinSessionDelegate.AddUObject(this, &ThisClass::OnJoinSession);
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::Tick));
+
+	FMultiplayerSessionMetrics::Get().Reset();
+	StartUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+	PeakUsedPhysical = StartUsedPhysical;
+	StartTime = FPlatformTime::Seconds();
+
+	UE_LOG(LogMultiplayerSessions, Log, TEXT("Session churn benchmark started, %d cycles"), NumCycles);
+	BeginCycle();
+}
+
+void USessionChurnBenchmark::SetStage(EStage NewStage)
+{
+	Stage = NewStage;
+	StageStartTime = FPlatformTime::Seconds();
+}
+
+void USessionChurnBenchmark::BeginCycle()
+{
+	if (CompletedCycles >= NumCycles)
+	{
+		Finish(false);
+		return;
+	}
+
+	SetStage(EStage::Creating);
+	Subsystem->CreateSession(4, MakeBenchmarkAttributes());
+}
+
+void USessionChurnBenchmark::RequestDestroy()
+{
+	SetStage(EStage::Destroying);
+	Subsystem->DestroySessions();
+}
+
+void USessionChurnBenchmark::OnCreateSession(bool bWasSuccessful)
+{
+	if (Stage != EStage::Creating)
+	{
+		return;
+	}
+
+	//The subsystem queues the start itself once a create succeeded
+	if (bWasSuccessful)
+	{
+		SetStage(EStage::Starting);
+	}
+	else
+	{
+		RequestDestroy();
+	}
+}
+
+void USessionChurnBenchmark::OnStartSession(bool bWasSuccessful)
+{
+	if (Stage != EStage::Starting)
+	{
+		return;
+	}
+
+	//Every cycle measures a real search rather than a cache hit
+	SetStage(EStage::Finding);
+	Subsystem->InvalidateSearchCache();
+	Subsystem->FindSessions(BenchmarkSearchResults, MakeBenchmarkAttributes());
+}
+
+void USessionChurnBenchmark::OnFindSession(const TArray<FOnlineSessionSearchResult>& SessionResults, bool bWasSuccessful)
+{
+	if (Stage != EStage::Finding)
+	{
+		return;
+	}
+
+	if (SessionResults.Num() > 0)
+	{
+		SetStage(EStage::Joining);
+		Subsystem->JoinBestSession(SessionResults, MakeBenchmarkAttributes());
+	}
+	else
+	{
+		RequestDestroy();
+	}
+}
+
+void USessionChurnBenchmark::OnJoinSession(EOnJoinSessionCompleteResult::Type Result)
+{
+	if (Stage != EStage::Joining)
+	{
+		return;
+	}
+
+	if (Result == EOnJoinSessionCompleteResult::Success)
+	{
+		++SuccessfulJoins;
+	}
+	RequestDestroy();
+}
+
+void USessionChurnBenchmark::OnDestroySession(bool bWasSuccessful)
+{
+	//Joins destroy the hosted session first, those broadcasts are not the end of a cycle
+	if (Stage != EStage::Destroying)
+	{
+		return;
+	}
+
+	++CompletedCycles;
+	BeginCycle();
+}
+
+void USessionChurnBenchmark::Finish(bool bInTimedOut)
+{
+	bTimedOut = bInTimedOut;
+	EndTime = FPlatformTime::Seconds();
+
+	//Report once the last callback has unwound and the queue is idle, or handles look leaked
+	SetStage(EStage::Draining);
+}
+
+bool USessionChurnBenchmark::Tick(float DeltaTime)
+{
+	PeakUsedPhysical = FMath::Max<uint64>(PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+
+	const double StageTime = FPlatformTime::Seconds() - StageStartTime;
+	if (Stage == EStage::Draining)
+	{
+		const bool bIdle = !Subsystem->HasOperationInFlight() && Subsystem->GetNumPendingOperations() == 0 && Subsystem->GetNumPendingBackendCalls() == 0;
+		if (!bIdle && StageTime < StageTimeoutSeconds)
+		{
+			return true;
+		}
+
+		WriteReport();
+
+		Subsystem->MultiplayerOnCreateSessionDelegate.RemoveDynamic(this, &ThisClass::OnCreateSession);
+		Subsystem->MultiplayerOnStartSessionDelegate.RemoveDynamic(this, &ThisClass::OnStartSession);
+		Subsystem->MultiplayerOnDestroySessionDelegate.RemoveDynamic(this, &ThisClass::OnDestroySession);
+		Subsystem->MultiplayerOnFindSessionDelegate.Remove(FindSessionHandle);
+		Subsystem->MultiplayerOnJoinSessionDelegate.Remove(JoinSessionHandle);
+
+		ActiveBenchmark.Reset();
+		RemoveFromRoot();
+
+		if (bExitWhenDone)
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+		return false;
+	}
+
+	if (StageTime > StageTimeoutSeconds)
+	{
+		UE_LOG(LogMultiplayerSessions, Warning, TEXT("Session churn benchmark stalled in stage %d of cycle %d"), static_cast<int32>(Stage), CompletedCycles);
+		Finish(true);
+	}
+	return true;
+}
+
+void USessionChurnBenchmark::WriteReport()
+{
+	const FMultiplayerSessionMetrics& Metrics = FMultiplayerSessionMetrics::Get();
+	const double Duration = FMath::Max(EndTime - StartTime, SMALL_NUMBER);
+
+	TSharedRef<FJsonObject> Operations = MakeShared<FJsonObject>();
+	uint64 TotalOperations = 0;
+
+	for (int32 Index = 0; Index < static_cast<int32>(ESessionOperation::Count); ++Index)
+	{
+		const ESessionOperation Operation = static_cast<ESessionOperation>(Index);
+		const FSessionLatencyHistogram& Histogram = Metrics.GetHistogram(Operation);
+		TotalOperations += Histogram.GetCount();
+
+		TSharedRef<FJsonObject> Entry = MakeShared<FJsonObject>();
+		Entry->SetNumberField(TEXT("count"), Histogram.GetCount());
+		Entry->SetNumberField(TEXT("successes"), Metrics.GetSuccesses(Operation));
+		Entry->SetNumberField(TEXT("failures"), Metrics.GetFailures(Operation));
+		Entry->SetNumberField(TEXT("meanMs"), Histogram.GetMean() / 1000.0);
+		Entry->SetNumberField(TEXT("p50Ms"), Histogram.GetPercentile(50.0) / 1000.0);
+		Entry->SetNumberField(TEXT("p95Ms"), Histogram.GetPercentile(95.0) / 1000.0);
+		Entry->SetNumberField(TEXT("p99Ms"), Histogram.GetPercentile(99.0) / 1000.0);
+		Entry->SetNumberField(TEXT("maxMs"), Histogram.GetMax() / 1000.0);
+		Entry->SetNumberField(TEXT("retries"), Metrics.GetRetries(Operation));
+		Entry->SetNumberField(TEXT("timeouts"), Metrics.GetTimeouts(Operation));
+		Entry->SetNumberField(TEXT("hedges"), Metrics.GetHedges(Operation));
+		Entry->SetNumberField(TEXT("hedgeWins"), Metrics.GetHedgeWins(Operation));
+		Operations->SetObjectField(LexToString(Operation), Entry);
+	}
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	TSharedRef<FJsonObject> Memory = MakeShared<FJsonObject>();
+	Memory->SetNumberField(TEXT("startUsedMB"), ToMegabytes(StartUsedPhysical));
+	Memory->SetNumberField(TEXT("peakUsedMB"), ToMegabytes(PeakUsedPhysical));
+	Memory->SetNumberField(TEXT("endUsedMB"), ToMegabytes(MemoryStats.UsedPhysical));
+	Memory->SetNumberField(TEXT("processPeakUsedMB"), ToMegabytes(MemoryStats.PeakUsedPhysical));
+
+	const int32 LeakedDelegateHandles = Subsystem->GetNumBoundBackendDelegates();
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("backend"), Subsystem->IsUsingMockSessionBackend() ? TEXT("Mock") : TEXT("Platform"));
+	Root->SetNumberField(TEXT("cycles"), NumCycles);
+	Root->SetNumberField(TEXT("completedCycles"), CompletedCycles);
+	Root->SetNumberField(TEXT("successfulJoins"), SuccessfulJoins);
+	Root->SetNumberField(TEXT("durationSeconds"), Duration);
+	Root->SetNumberField(TEXT("operations"), static_cast<double>(TotalOperations));
+	Root->SetNumberField(TEXT("operationsPerSecond"), TotalOperations / Duration);
+	Root->SetObjectField(TEXT("latency"), Operations);
+	Root->SetObjectField(TEXT("memory"), Memory);
+	Root->SetNumberField(TEXT("leakedDelegateHandles"), LeakedDelegateHandles);
+	Root->SetNumberField(TEXT("pendingOperations"), Subsystem->GetNumPendingOperations() + Subsystem->HasOperationInFlight());
+	Root->SetNumberField(TEXT("pendingBackendCalls"), Subsystem->GetNumPendingBackendCalls());
+	Root->SetBoolField(TEXT("timedOut"), bTimedOut);
+	Root->SetBoolField(TEXT("passed"), !bTimedOut && LeakedDelegateHandles == 0 && CompletedCycles == NumCycles);
+
+	FString Report;
+	FJsonSerializer::Serialize(Root, TJsonWriterFactory<>::Create(&Report));
+
+	const FString ReportPath = OutputDirectory / FString::Printf(TEXT("SessionChurn-%s.json"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+	if (FFileHelper::SaveStringToFile(Report, *ReportPath))
+	{
+		UE_LOG(LogMultiplayerSessions, Log, TEXT("Session churn benchmark: %d/%d cycles, %.1f ops/s, %d leaked handles, report %s"),
+			CompletedCycles, NumCycles, TotalOperations / Duration, LeakedDelegateHandles, *ReportPath);
+	}
+	else
+	{
+		UE_LOG(LogMultiplayerSessions, Warning, TEXT("Could not write session churn report to %s"), *ReportPath);
+	}
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Containers/Ticker.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "SessionChurnBenchmark.generated.h"
+
+class UMultiplayerSessionsSubsystem;
+
+/**
+ * Drives the sessions subsystem through create/start/find/join/destroy cycles and writes a JSON report with
+ * operations per second, latency percentiles, peak memory and leaked delegate handles.
+ * Run with "Multiplayer.Bench.SessionChurn [Cycles=N] [Output=Dir] [Exit]", ideally against -MockSessionBackend or NULL
+ * and from a map without the menu, which would react to the same broadcasts.
+ */
+UCLASS()
+class USessionChurnBenchmark : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	static USessionChurnBenchmark* Run(UMultiplayerSessionsSubsystem* InSubsystem, int32 InNumCycles, const FString& InOutputDirectory, bool bInExitWhenDone);
+
+private:
+
+	enum class EStage : uint8
+	{
+		Idle,
+		Creating,
+		Starting,
+		Finding,
+		Joining,
+		Destroying,
+		Draining
+	};
+
+	void Begin();
+	void BeginCycle();
+	void RequestDestroy();
+	void SetStage(EStage NewStage);
+	void Finish(bool bInTimedOut);
+	bool Tick(float DeltaTime);
+	void WriteReport();
+
+	UFUNCTION()
+	void OnCreateSession(bool bWasSuccessful);
+
+	UFUNCTION()
+	void OnStartSession(bool bWasSuccessful);
+
+	UFUNCTION()
+	void OnDestroySession(bool bWasSuccessful);
+
+	void OnFindSession(const TArray<FOnlineSessionSearchResult>& SessionResults, bool bWasSuccessful);
+	void OnJoinSession(EOnJoinSessionCompleteResult::Type Result);
+
+	UPROPERTY()
+	UMultiplayerSessionsSubsystem* Subsystem = nullptr;
+
+	int32 NumCycles = 0;
+	int32 CompletedCycles = 0;
+	int32 SuccessfulJoins = 0;
+	FString OutputDirectory;
+	bool bExitWhenDone = false;
+	bool bTimedOut = false;
+
+	EStage Stage = EStage::Idle;
+	double StageStartTime = 0.0;
+	double StartTime = 0.0;
+	double EndTime = 0.0;
+
+	uint64 StartUsedPhysical = 0;
+	uint64 PeakUsedPhysical = 0;
+
+	FDelegateHandle FindSessionHandle;
+	FDelegateHandle JoinSessionHandle;
+	FTSTicker::FDelegateHandle TickHandle;
+
+	//A step taking longer than this stalls the run
+	static constexpr double StageTimeoutSeconds = 30.0;
+};
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionLatencyHistogram.h"
+
+FSessionLatencyHistogram::FSessionLatencyHistogram()
+{
+	Reset();
+}
+
+void FSessionLatencyHistogram::Record(uint64 ValueMicroseconds)
+{
+	Buckets[GetBucketIndex(ValueMicroseconds)].fetch_add(1, std::memory_order_relaxed);
+	Count.fetch_add(1, std::memory_order_relaxed);
+	Sum.fetch_add(ValueMicroseconds, std::memory_order_relaxed);
+
+	uint64 CurrentMax = MaxValue.load(std::memory_order_relaxed);
+	while (ValueMicroseconds > CurrentMax && !MaxValue.compare_exchange_weak(CurrentMax, ValueMicroseconds, std::memory_order_relaxed))
+	{
+	}
+}
+
+void FSessionLatencyHistogram::Reset()
+{
+	for (std::atomic<uint64>& Bucket : Buckets)
+	{
+		Bucket.store(0, std::memory_order_relaxed);
+	}
+	Count.store(0, std::memory_order_relaxed);
+	Sum.store(0, std::memory_order_relaxed);
+	MaxValue.store(0, std::memory_order_relaxed);
+}
+
+double FSessionLatencyHistogram::GetMean() const
+{
+	const uint64 NumValues = GetCount();
+	return NumValues > 0 ? static_cast<double>(Sum.load(std::memory_order_relaxed)) / NumValues : 0.0;
+}
+
+uint64 FSessionLatencyHistogram::GetPercentile(double Percentile) const
+{
+	const uint64 NumValues = GetCount();
+	if (NumValues == 0)
+	{
+		return 0;
+	}
+
+	const uint64 Target = FMath::Max<uint64>(1, static_cast<uint64>(FMath::CeilToDouble(FMath::Clamp(Percentile, 0.0, 100.0) / 100.0 * NumValues)));
+
+	uint64 Cumulative = 0;
+	for (int32 BucketIndex = 0; BucketIndex < NumBuckets; ++BucketIndex)
+	{
+		Cumulative += GetBucketCount(BucketIndex);
+		if (Cumulative >= Target)
+		{
+			return FMath::Min(GetBucketUpperBound(BucketIndex), GetMax());
+		}
+	}
+	return GetMax();
+}
+
+int32 FSessionLatencyHistogram::GetBucketIndex(uint64 Value)
+{
+	//Values below 2 * SubBucketCount get a bucket each
+	if (Value < 2 * SubBucketCount)
+	{
+		return static_cast<int32>(Value);
+	}
+
+	const int32 Shift = FMath::Min(static_cast<int32>(FMath::FloorLog2_64(Value)) - SubBucketBits, MaxShift);
+	const int32 SubBucket = FMath::Min(static_cast<int32>(Value >> Shift), 2 * SubBucketCount - 1) - SubBucketCount;
+	return 2 * SubBucketCount + (Shift - 1) * SubBucketCount + SubBucket;
+}
+
+uint64 FSessionLatencyHistogram::GetBucketLowerBound(int32 BucketIndex)
+{
+	if (BucketIndex < 2 * SubBucketCount)
+	{
+		return BucketIndex;
+	}
+
+	const int32 Offset = BucketIndex - 2 * SubBucketCount;
+	const int32 Shift = Offset / SubBucketCount + 1;
+	const uint64 SubBucket = Offset % SubBucketCount + SubBucketCount;
+	return SubBucket << Shift;
+}
+
+uint64 FSessionLatencyHistogram::GetBucketUpperBound(int32 BucketIndex)
+{
+	if (BucketIndex < 2 * SubBucketCount)
+	{
+		return BucketIndex;
+	}
+
+	const int32 Offset = BucketIndex - 2 * SubBucketCount;
+	const int32 Shift = Offset / SubBucketCount + 1;
+	const uint64 SubBucket = Offset % SubBucketCount + SubBucketCount;
+	return ((SubBucket + 1) << Shift) - 1;
+}
@@ -0,0 +1,292 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionPingProber.h"
+#include "Multiplayer.h"
+#include "Common/UdpSocketBuilder.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+#include "IPAddress.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+namespace
+{
+	//Probes start with this so stray traffic on the port is ignored
+	constexpr uint32 ProbeMagic = 0x4D505042;
+
+	//Magic, probe id, target index, attempt
+	constexpr int32 ProbeSize = 12;
+
+	//Unanswered targets get one more probe halfway through the budget, a single lost packet shouldn't rule a host out
+	constexpr int32 MaxAttempts = 2;
+
+	void WriteUInt32(uint8* Data, uint32 Value)
+	{
+		Data[0] = Value & 0xFF;
+		Data[1] = (Value >> 8) & 0xFF;
+		Data[2] = (Value >> 16) & 0xFF;
+		Data[3] = (Value >> 24) & 0xFF;
+	}
+
+	uint32 ReadUInt32(const uint8* Data)
+	{
+		return Data[0] | (Data[1] << 8) | (Data[2] << 16) | (static_cast<uint32>(Data[3]) << 24);
+	}
+
+	bool IsProbe(const uint8* Data, int32 Size)
+	{
+		return Size == ProbeSize && ReadUInt32(Data) == ProbeMagic;
+	}
+}
+
+
+//Prober
+
+FSessionPingProber::~FSessionPingProber()
+{
+	Cancel();
+}
+
+bool FSessionPingProber::Start(const TArray<TSharedPtr<FInternetAddr>>& InTargets, float InBudgetSeconds, FOnProbeComplete&& InOnComplete)
+{
+	Cancel();
+
+	if (InTargets.Num() == 0)
+	{
+		return false;
+	}
+
+	Socket = FUdpSocketBuilder(TEXT("SessionPingProber")).AsNonBlocking().BoundToPort(0).Build();
+	if (Socket == nullptr)
+	{
+		UE_LOG(LogMultiplayerSessions, Warning, TEXT("Session ping prober could not open a socket"));
+		return false;
+	}
+
+	Targets = InTargets;
+	OnComplete = MoveTemp(InOnComplete);
+	RttMs.Init(INDEX_NONE, Targets.Num());
+	SendTimes.Init(0.0, Targets.Num() * MaxAttempts);
+	ProbeId = FMath::Rand() ^ static_cast<uint32>(FPlatformTime::Cycles());
+	NumAnswered = 0;
+	NumAttemptsSent = 0;
+	StartTime = FPlatformTime::Seconds();
+	BudgetSeconds = FMath::Max(InBudgetSeconds, 0.0f);
+
+	SendProbes(0);
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FSessionPingProber::Tick));
+	return true;
+}
+
+void FSessionPingProber::Cancel()
+{
+	if (TickHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+		TickHandle.Reset();
+	}
+	CloseSocket();
+	OnComplete = nullptr;
+}
+
+TSharedPtr<FInternetAddr> FSessionPingProber::ResolveProbeAddress(const FString& ConnectString, int32 PortOffset)
+{
+	FString Host;
+	FString PortString;
+	if (!ConnectString.Split(TEXT(":"), &Host, &PortString, ESearchCase::IgnoreCase, ESearchDir::FromEnd))
+	{
+		return nullptr;
+	}
+
+	const int32 GamePort = FCString::Atoi(*PortString);
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	if (GamePort <= 0 || SocketSubsystem == nullptr)
+	{
+		return nullptr;
+	}
+
+	TSharedRef<FInternetAddr> Address = SocketSubsystem->CreateInternetAddr();
+	bool bIsValid = false;
+	Address->SetIp(*Host, bIsValid);
+	if (!bIsValid)
+	{
+		return nullptr;
+	}
+
+	Address->SetPort(GamePort + PortOffset);
+	return Address;
+}
+
+bool FSessionPingProber::Tick(float DeltaTime)
+{
+	ReceiveReplies();
+
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+	if (NumAnswered == Targets.Num() || Elapsed >= BudgetSeconds)
+	{
+		TickHandle.Reset();
+		Finish();
+		return false;
+	}
+
+	if (NumAttemptsSent < MaxAttempts && Elapsed >= BudgetSeconds * NumAttemptsSent / MaxAttempts)
+	{
+		SendProbes(NumAttemptsSent);
+	}
+	return true;
+}
+
+void FSessionPingProber::SendProbes(int32 Attempt)
+{
+	uint8 Probe[ProbeSize];
+	WriteUInt32(Probe, ProbeMagic);
+	WriteUInt32(Probe + 4, ProbeId);
+
+	const double Now = FPlatformTime::Seconds();
+	for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); ++TargetIndex)
+	{
+		if (RttMs[TargetIndex] != INDEX_NONE)
+		{
+			continue;
+		}
+
+		WriteUInt32(Probe + 8, (TargetIndex & 0xFFFF) | (Attempt << 16));
+		int32 BytesSent = 0;
+		SendTimes[TargetIndex * MaxAttempts + Attempt] = Now;
+		Socket->SendTo(Probe, ProbeSize, BytesSent, *Targets[TargetIndex]);
+	}
+	NumAttemptsSent = Attempt + 1;
+}
+
+void FSessionPingProber::ReceiveReplies()
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	TSharedRef<FInternetAddr> FromAddress = SocketSubsystem->CreateInternetAddr();
+
+	uint8 Reply[ProbeSize + 1];
+	int32 BytesRead = 0;
+	while (Socket->RecvFrom(Reply, sizeof(Reply), BytesRead, *FromAddress) && BytesRead > 0)
+	{
+		//Late replies to an earlier run share the port, the probe id tells them apart
+		if (!IsProbe(Reply, BytesRead) || ReadUInt32(Reply + 4) != ProbeId)
+		{
+			continue;
+		}
+
+		const uint32 TargetAndAttempt = ReadUInt32(Reply + 8);
+		const int32 TargetIndex = TargetAndAttempt & 0xFFFF;
+		const int32 Attempt = TargetAndAttempt >> 16;
+		if (!Targets.IsValidIndex(TargetIndex) || Attempt >= MaxAttempts || RttMs[TargetIndex] != INDEX_NONE || !(*FromAddress == *Targets[TargetIndex]))
+		{
+			continue;
+		}
+
+		const double SendTime = SendTimes[TargetIndex * MaxAttempts + Attempt];
+		RttMs[TargetIndex] = FMath::RoundToInt((FPlatformTime::Seconds() - SendTime) * 1000.0);
+		++NumAnswered;
+	}
+}
+
+void FSessionPingProber::Finish()
+{
+	CloseSocket();
+
+	//Listeners usually drop the prober from inside the callback
+	TSharedRef<FSessionPingProber> KeepAlive = AsShared();
+	FOnProbeComplete Completion = MoveTemp(OnComplete);
+	OnComplete = nullptr;
+	if (Completion)
+	{
+		Completion(RttMs);
+	}
+}
+
+void FSessionPingProber::CloseSocket()
+{
+	if (Socket)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+}
+
+
+//Responder
+
+FSessionPingResponder::~FSessionPingResponder()
+{
+	Stop();
+}
+
+bool FSessionPingResponder::Start(int32 InPort, bool bLoopbackOnly, int32 InReplyDelayMs)
+{
+	Stop();
+
+	Socket = FUdpSocketBuilder(TEXT("SessionPingResponder"))
+		.AsNonBlocking()
+		.BoundToAddress(bLoopbackOnly ? FIPv4Address(127, 0, 0, 1) : FIPv4Address::Any)
+		.BoundToPort(InPort)
+		.Build();
+
+	if (Socket == nullptr)
+	{
+		UE_LOG(LogMultiplayerSessions, Warning, TEXT("Session ping responder could not bind port %d"), InPort);
+		return false;
+	}
+
+	Port = InPort;
+	ReplyDelayMs = FMath::Max(InReplyDelayMs, 0);
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FSessionPingResponder::Tick));
+	return true;
+}
+
+void FSessionPingResponder::Stop()
+{
+	if (TickHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+		TickHandle.Reset();
+	}
+
+	if (Socket)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+	PendingReplies.Reset();
+}
+
+bool FSessionPingResponder::Tick(float DeltaTime)
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	const double Now = FPlatformTime::Seconds();
+
+	uint8 Probe[ProbeSize + 1];
+	int32 BytesRead = 0;
+	TSharedRef<FInternetAddr> FromAddress = SocketSubsystem->CreateInternetAddr();
+	while (Socket->RecvFrom(Probe, sizeof(Probe), BytesRead, *FromAddress) && BytesRead > 0)
+	{
+		if (!IsProbe(Probe, BytesRead))
+		{
+			continue;
+		}
+
+		FPendingReply& Reply = PendingReplies.AddDefaulted_GetRef();
+		Reply.SendTime = Now + ReplyDelayMs / 1000.0;
+		Reply.Address = FromAddress;
+		Reply.Payload.Append(Probe, ProbeSize);
+		FromAddress = SocketSubsystem->CreateInternetAddr();
+	}
+
+	//Replies are queued in arrival order and share one delay, so the due ones are always at the front
+	int32 NumSent = 0;
+	for (; NumSent < PendingReplies.Num() && PendingReplies[NumSent].SendTime <= Now; ++NumSent)
+	{
+		const FPendingReply& Reply = PendingReplies[NumSent];
+		int32 BytesSent = 0;
+		Socket->SendTo(Reply.Payload.GetData(), Reply.Payload.Num(), BytesSent, *Reply.Address);
+	}
+	PendingReplies.RemoveAt(0, NumSent, false);
+	return true;
+}
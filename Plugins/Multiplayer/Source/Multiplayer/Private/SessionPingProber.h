@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+class FInternetAddr;
+class FSocket;
+
+/**
+ * Measures the round trip to a set of hosts with one UDP probe each, all sent at once.
+ * Finishes as soon as every host answered or the time budget ran out, whichever comes first.
+ * Both ends poll on the core ticker, so a measurement carries up to a frame of slack on each side.
+ */
+class FSessionPingProber : public TSharedFromThis<FSessionPingProber>
+{
+public:
+
+	~FSessionPingProber();
+
+	//Round trip per target in ms, INDEX_NONE for targets that didn't answer within the budget
+	using FOnProbeComplete = TFunction<void(const TArray<int32>& RttMs)>;
+
+	bool Start(const TArray<TSharedPtr<FInternetAddr>>& InTargets, float BudgetSeconds, FOnProbeComplete&& InOnComplete);
+
+	//Stops without calling back
+	void Cancel();
+	bool IsRunning() const { return Socket != nullptr; }
+
+	//Address a host answers probes on, null for connect strings that aren't ip:port (Steam P2P ids)
+	static TSharedPtr<FInternetAddr> ResolveProbeAddress(const FString& ConnectString, int32 PortOffset);
+
+private:
+
+	bool Tick(float DeltaTime);
+	void SendProbes(int32 Attempt);
+	void ReceiveReplies();
+	void Finish();
+	void CloseSocket();
+
+	FSocket* Socket = nullptr;
+	FTSTicker::FDelegateHandle TickHandle;
+	FOnProbeComplete OnComplete;
+
+	TArray<TSharedPtr<FInternetAddr>> Targets;
+	TArray<int32> RttMs;
+
+	//Send time of every attempt per target, replies carry the attempt they answer
+	TArray<double> SendTimes;
+	uint32 ProbeId = 0;
+	int32 NumAnswered = 0;
+	int32 NumAttemptsSent = 0;
+	double StartTime = 0.0;
+	double BudgetSeconds = 0.0;
+};
+
+/**
+ * Echoes probes back to the prober, run by hosts on their game port plus the probe offset.
+ * A reply delay makes loopback stand-ins look like hosts at different distances.
+ */
+class FSessionPingResponder
+{
+public:
+
+	~FSessionPingResponder();
+
+	bool Start(int32 InPort, bool bLoopbackOnly = false, int32 InReplyDelayMs = 0);
+	void Stop();
+	bool IsRunning() const { return Socket != nullptr; }
+	int32 GetPort() const { return Port; }
+
+private:
+
+	bool Tick(float DeltaTime);
+
+	struct FPendingReply
+	{
+		double SendTime = 0.0;
+		TSharedPtr<FInternetAddr> Address;
+		TArray<uint8> Payload;
+	};
+
+	FSocket* Socket = nullptr;
+	FTSTicker::FDelegateHandle TickHandle;
+	TArray<FPendingReply> PendingReplies;
+	int32 Port = 0;
+	int32 ReplyDelayMs = 0;
+};
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionSearchCache.h"
+#include "OnlineSessionSettings.h"
+
+FString FSessionSearchCache::MakeKey(const FOnlineSessionSearch& Search)
+{
+	FString Key = FString::Printf(TEXT("Max=%d;Lan=%d"), Search.MaxSearchResults, Search.bIsLanQuery ? 1 : 0);
+
+	//Map order is not stable so sort the query settings by name first
+	TArray<FName> ParamNames;
+	Search.QuerySettings.SearchParams.GetKeys(ParamNames);
+	ParamNames.Sort(FNameLexicalLess());
+
+	for (const FName& ParamName : ParamNames)
+	{
+		const FOnlineSessionSearchParam& Param = Search.QuerySettings.SearchParams.FindChecked(ParamName);
+		Key += FString::Printf(TEXT(";%s%s%s"), *ParamName.ToString(), EOnlineComparisonOp::ToString(Param.ComparisonOp), *Param.Data.ToString());
+	}
+
+	return Key;
+}
+
+FSessionSearchCache::ELookupResult FSessionSearchCache::Find(const FString& Key, double Now, float TTL, float StaleTTL, TSharedPtr<FOnlineSessionSearch>& OutSearch)
+{
+	const FEntry* Entry = Entries.Find(Key);
+	if (Entry == nullptr || !Entry->Search.IsValid())
+	{
+		++Stats.Misses;
+		return ELookupResult::Miss;
+	}
+
+	const double Age = Now - Entry->StoredTime;
+	if (Age <= TTL)
+	{
+		++Stats.Hits;
+		OutSearch = Entry->Search;
+		return ELookupResult::Fresh;
+	}
+
+	if (Age <= FMath::Max(TTL, StaleTTL))
+	{
+		++Stats.StaleHits;
+		OutSearch = Entry->Search;
+		return ELookupResult::Stale;
+	}
+
+	//Too old to be worth showing, drop it
+	Entries.Remove(Key);
+	++Stats.Misses;
+	return ELookupResult::Miss;
+}
+
+bool FSessionSearchCache::Peek(const FString& Key, double Now, TSharedPtr<FOnlineSessionSearch>& OutSearch, double& OutAge) const
+{
+	const FEntry* Entry = Entries.Find(Key);
+	if (Entry == nullptr || !Entry->Search.IsValid())
+	{
+		return false;
+	}
+
+	OutSearch = Entry->Search;
+	OutAge = Now - Entry->StoredTime;
+	return true;
+}
+
+void FSessionSearchCache::Store(const FString& Key, const TSharedPtr<FOnlineSessionSearch>& Search, double Now, int32 NumBackendResults)
+{
+	FEntry& Entry = Entries.FindOrAdd(Key);
+	Entry.Search = Search;
+	Entry.StoredTime = Now;
+	Entry.NumBackendResults = NumBackendResults != INDEX_NONE ? NumBackendResults : (Search.IsValid() ? Search->SearchResults.Num() : 0);
+}
+
+int32 FSessionSearchCache::GetNumBackendResults(const FString& Key) const
+{
+	const FEntry* Entry = Entries.Find(Key);
+	return Entry ? Entry->NumBackendResults : INDEX_NONE;
+}
+
+void FSessionSearchCache::RecordRefresh(double Latency)
+{
+	++Stats.Refreshes;
+	Stats.LastRefreshLatency = Latency;
+	Stats.TotalRefreshLatency += Latency;
+}
+
+void FSessionSearchCache::Invalidate()
+{
+	Entries.Reset();
+}
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SessionSelector.h"
+
+FSessionSelector::FSessionSelector(const FMultiplayerSessionAttributes& InDesired, const FSessionSelectionWeights& InWeights) :
+	Desired(InDesired),
+	Weights(InWeights)
+{
+}
+
+FSessionSelector::FInternedDesired FSessionSelector::Intern(const FMultiplayerSessionSummary& Summary) const
+{
+	FInternedDesired Interned;
+	Interned.MatchType = Summary.FindString(Desired.MatchType);
+	Interned.Region = Summary.FindString(Desired.Region);
+	Interned.MapName = Summary.FindString(Desired.MapName);
+	return Interned;
+}
+
+float FSessionSelector::Score(const FMultiplayerSessionSummary& Summary, int32 Index) const
+{
+	return Score(Summary, Index, Intern(Summary));
+}
+
+float FSessionSelector::Score(const FMultiplayerSessionSummary& Summary, int32 Index, const FInternedDesired& Interned) const
+{
+	if (!Summary.HasFlag(Index, FMultiplayerSessionSummary::Valid) || Summary.OpenSlots[Index] <= 0)
+	{
+		return -1.0f;
+	}
+
+	//Hard requirements, joining these would only fail on the host
+	if (!Desired.MatchType.IsEmpty() && Summary.MatchTypes[Index] != Interned.MatchType)
+	{
+		return -1.0f;
+	}
+	const int32 BuildId = Summary.BuildIds[Index];
+	if (Desired.BuildId != INDEX_NONE && BuildId != INDEX_NONE && BuildId != Desired.BuildId)
+	{
+		return -1.0f;
+	}
+
+	const float PingScore = 1.0f - FMath::Clamp(static_cast<float>(Summary.Pings[Index]) / FMath::Max(Weights.MaxAcceptablePingMs, 1), 0.0f, 1.0f);
+
+	const int32 MaxSlots = Summary.MaxSlots[Index];
+	const float OpenScore = MaxSlots > 0
+		? static_cast<float>(Summary.OpenSlots[Index]) / MaxSlots
+		: 0.0f;
+
+	//Soft preferences, every wanted attribute the host shares adds to the score
+	int32 NumWanted = 0;
+	int32 NumMatched = 0;
+	if (!Desired.Region.IsEmpty())
+	{
+		++NumWanted;
+		NumMatched += Summary.Regions[Index] == Interned.Region ? 1 : 0;
+	}
+	if (!Desired.MapName.IsEmpty())
+	{
+		++NumWanted;
+		NumMatched += Summary.MapNames[Index] == Interned.MapName ? 1 : 0;
+	}
+	float AttributeScore = NumWanted > 0 ? static_cast<float>(NumMatched) / NumWanted : 1.0f;
+	const int32 SkillBucket = Summary.SkillBuckets[Index];
+	if (Desired.SkillBucket != INDEX_NONE && SkillBucket != INDEX_NONE)
+	{
+		//Neighbouring skill buckets are still decent matches
+		const float SkillScore = 1.0f / (1.0f + FMath::Abs(SkillBucket - Desired.SkillBucket));
+		AttributeScore = NumWanted > 0 ? (AttributeScore * NumWanted + SkillScore) / (NumWanted + 1) : SkillScore;
+	}
+
+	//Dedicated hosts don't drop the session when one player quits
+	float HostScore = Summary.HasFlag(Index, FMultiplayerSessionSummary::Dedicated) ? 1.0f : 0.5f;
+	if (!Summary.HasFlag(Index, FMultiplayerSessionSummary::JoinInProgress))
+	{
+		HostScore *= 0.5f;
+	}
+
+	//A host running out of frame budget will lag everyone who joins it
+	const int32 ServerLoad = Summary.ServerLoads[Index];
+	if (ServerLoad != INDEX_NONE)
+	{
+		HostScore *= 1.0f - 0.5f * FMath::Clamp(ServerLoad / 100.0f, 0.0f, 1.0f);
+	}
+
+	return
+		Weights.Ping * PingScore +
+		Weights.OpenConnections * OpenScore +
+		Weights.AttributeMatch * AttributeScore +
+		Weights.HostQuality * HostScore;
+}
+
+TArray<int32> FSessionSelector::Rank(const FMultiplayerSessionSummary& Summary, int32 MaxCandidates) const
+{
+	const FInternedDesired Interned = Intern(Summary);
+
+	TArray<TPair<float, int32>> Scored;
+	Scored.Reserve(Summary.Num());
+
+	for (int32 Index = 0; Index < Summary.Num(); ++Index)
+	{
+		const float CandidateScore = Score(Summary, Index, Interned);
+		if (CandidateScore >= 0.0f)
+		{
+			Scored.Emplace(CandidateScore, Index);
+		}
+	}
+
+	Scored.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B)
+	{
+		return A.Key > B.Key;
+	});
+
+	TArray<int32> Ranked;
+	const int32 NumRanked = MaxCandidates > 0 ? FMath::Min(MaxCandidates, Scored.Num()) : Scored.Num();
+	Ranked.Reserve(NumRanked);
+	for (int32 Index = 0; Index < NumRanked; ++Index)
+	{
+		Ranked.Add(Scored[Index].Value);
+	}
+	return Ranked;
+}
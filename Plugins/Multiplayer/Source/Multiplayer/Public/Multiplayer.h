@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
+MULTIPLAYER_API DECLARE_LOG_CATEGORY_EXTERN(LogMultiplayerSessions, Log, All);
+
 class FMultiplayerModule : public IModuleInterface
 {
 public:
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "SessionOperation.h"
+
+class FOnlineSessionSettings;
+
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FMultiplayerOnSessionOperationDelegate, FName SessionName, ESessionOperation Operation, bool bWasSuccessful);
+
+/**
+ * One lane of the subsystem's operation queue. Calls in a lane go out one at a time, separate lanes run in parallel
+ */
+struct FSessionOperationLane
+{
+	TArray<FSessionOperation> PendingOperations;
+	FSessionOperation CurrentOperation;
+	bool bOperationInFlight = false;
+
+	//Interface the operation on the wire was issued to, its completion delegate is bound and cleared there
+	IOnlineSessionPtr OperationInterface;
+	FDelegateHandle CompleteDelegateHandle;
+};
+
+/**
+ * A session this process hosts or joined, with its own settings, state, callbacks and queue lane
+ */
+struct FMultiplayerNamedSession
+{
+	FName SessionName;
+
+	//Settings the session was created with, null for joined sessions
+	TSharedPtr<FOnlineSessionSettings> Settings;
+
+	//Mirrors the backend's state after every completed operation
+	EOnlineSessionState::Type State = EOnlineSessionState::NoSession;
+	bool bIsHost = false;
+
+	//Fires for every operation on this session, after the subsystem wide delegates
+	FMultiplayerOnSessionOperationDelegate OnOperationComplete;
+
+	FSessionOperationLane Lane;
+};
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+
+/**
+ * Compile time key for an advertised session attribute, the value type is fixed by the key
+ */
+template<typename ValueType>
+struct TMultiplayerSessionKey
+{
+	const TCHAR* Name;
+
+	FName GetName() const { return FName(Name); }
+
+	void Write(FOnlineSessionSettings& Settings, const ValueType& Value) const
+	{
+		Settings.Set(GetName(), Value, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+	}
+
+	bool Read(const FOnlineSessionSettings& Settings, ValueType& OutValue) const
+	{
+		return Settings.Get(GetName(), OutValue);
+	}
+
+	void Filter(FOnlineSearchSettings& QuerySettings, const ValueType& Value) const
+	{
+		QuerySettings.Set(GetName(), Value, EOnlineComparisonOp::Equals);
+	}
+};
+
+namespace MultiplayerSessionKeys
+{
+	constexpr TMultiplayerSessionKey<FString> MatchType{ TEXT("MatchType") };
+	constexpr TMultiplayerSessionKey<FString> Region{ TEXT("Region") };
+	constexpr TMultiplayerSessionKey<FString> MapName{ TEXT("MapName") };
+	constexpr TMultiplayerSessionKey<int32> BuildId{ TEXT("BuildId") };
+	constexpr TMultiplayerSessionKey<int32> SkillBucket{ TEXT("SkillBucket") };
+
+	//Live occupancy pushed by the host while the session runs, not part of the attributes a session is created with
+	constexpr TMultiplayerSessionKey<int32> PlayerCount{ TEXT("PlayerCount") };
+	constexpr TMultiplayerSessionKey<int32> ServerLoad{ TEXT("ServerLoad") };
+}
+
+/**
+ * Typed set of attributes a session is advertised with.
+ * Empty strings and INDEX_NONE mean "not set", which is skipped when writing and matches anything when filtering.
+ */
+struct MULTIPLAYER_API FMultiplayerSessionAttributes
+{
+	FString MatchType;
+	FString Region;
+	FString MapName;
+	int32 BuildId = INDEX_NONE;
+	int32 SkillBucket = INDEX_NONE;
+
+	//Advertises every set attribute on the session
+	void WriteTo(FOnlineSessionSettings& Settings) const;
+
+	//Pushes every set attribute into the search so the backend filters for us
+	void WriteFilters(FOnlineSearchSettings& QuerySettings) const;
+
+	//Used on results from backends that ignore QuerySettings
+	bool Matches(const FOnlineSessionSettings& Settings) const;
+
+	static FMultiplayerSessionAttributes ReadFrom(const FOnlineSessionSettings& Settings);
+};
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SessionLatencyHistogram.h"
+#include "SessionOperation.h"
+
+/**
+ * Process wide call-to-callback latencies and outcome counters for every session operation.
+ * Dump with "Multiplayer.Sessions.DumpLatency", export with "Multiplayer.Sessions.ExportLatencyCsv [Directory]".
+ */
+class MULTIPLAYER_API FMultiplayerSessionMetrics
+{
+public:
+
+	static FMultiplayerSessionMetrics& Get();
+
+	void Record(ESessionOperation Operation, double Seconds, bool bWasSuccessful);
+
+	//Attempts that were retried, abandoned at their deadline or cancelled, and hedged finds with the hedges that answered first
+	void RecordRetry(ESessionOperation Operation) { Operations[static_cast<int32>(Operation)].Retries.fetch_add(1, std::memory_order_relaxed); }
+	void RecordTimeout(ESessionOperation Operation) { Operations[static_cast<int32>(Operation)].Timeouts.fetch_add(1, std::memory_order_relaxed); }
+	void RecordCancellation(ESessionOperation Operation) { Operations[static_cast<int32>(Operation)].Cancellations.fetch_add(1, std::memory_order_relaxed); }
+	void RecordHedge(ESessionOperation Operation) { Operations[static_cast<int32>(Operation)].Hedges.fetch_add(1, std::memory_order_relaxed); }
+	void RecordHedgeWin(ESessionOperation Operation) { Operations[static_cast<int32>(Operation)].HedgeWins.fetch_add(1, std::memory_order_relaxed); }
+	void Reset();
+
+	const FSessionLatencyHistogram& GetHistogram(ESessionOperation Operation) const { return Operations[static_cast<int32>(Operation)].Histogram; }
+	uint64 GetSuccesses(ESessionOperation Operation) const { return Operations[static_cast<int32>(Operation)].Successes.load(std::memory_order_relaxed); }
+	uint64 GetFailures(ESessionOperation Operation) const { return Operations[static_cast<int32>(Operation)].Failures.load(std::memory_order_relaxed); }
+	uint64 GetRetries(ESessionOperation Operation) const { return Operations[static_cast<int32>(Operation)].Retries.load(std::memory_order_relaxed); }
+	uint64 GetTimeouts(ESessionOperation Operation) const { return Operations[static_cast<int32>(Operation)].Timeouts.load(std::memory_order_relaxed); }
+	uint64 GetCancellations(ESessionOperation Operation) const { return Operations[static_cast<int32>(Operation)].Cancellations.load(std::memory_order_relaxed); }
+	uint64 GetHedges(ESessionOperation Operation) const { return Operations[static_cast<int32>(Operation)].Hedges.load(std::memory_order_relaxed); }
+	uint64 GetHedgeWins(ESessionOperation Operation) const { return Operations[static_cast<int32>(Operation)].HedgeWins.load(std::memory_order_relaxed); }
+
+	//One line per operation with count, outcomes and p50/p95/p99 in milliseconds
+	void Dump(FOutputDevice& Ar) const;
+
+	//Writes a summary CSV and a raw bucket CSV, returns false if either could not be written
+	bool ExportCsv(const FString& Directory) const;
+
+private:
+
+	struct FOperationMetrics
+	{
+		FSessionLatencyHistogram Histogram;
+		std::atomic<uint64> Successes{ 0 };
+		std::atomic<uint64> Failures{ 0 };
+		std::atomic<uint64> Retries{ 0 };
+		std::atomic<uint64> Timeouts{ 0 };
+		std::atomic<uint64> Cancellations{ 0 };
+		std::atomic<uint64> Hedges{ 0 };
+		std::atomic<uint64> HedgeWins{ 0 };
+	};
+
+	FOperationMetrics Operations[static_cast<int32>(ESessionOperation::Count)];
+};
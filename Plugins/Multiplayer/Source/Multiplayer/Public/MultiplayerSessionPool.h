@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Counters for the warm session pool
+ */
+struct MULTIPLAYER_API FSessionPoolStats
+{
+	//Hosts served from the pool, and hosts that found it empty and created a session the slow way
+	int32 Claims = 0;
+	int32 Misses = 0;
+
+	int32 Refills = 0;
+	int32 RefillFailures = 0;
+
+	//Seconds from asking for a warm session to it being ready to claim
+	double LastRefillLatency = 0.0;
+	double TotalRefillLatency = 0.0;
+	double MaxRefillLatency = 0.0;
+
+	double GetAverageRefillLatency() const
+	{
+		return Refills > 0 ? TotalRefillLatency / Refills : 0.0;
+	}
+};
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FOnlineSessionSearch;
+class FOnlineSessionSearchResult;
+
+/**
+ * Struct of arrays view over session search results, built once per search.
+ * Index i of every column describes the same session. Attribute strings are interned so UI and selection code
+ * compare ints, and the full result is only resolved for the session actually being joined.
+ */
+struct MULTIPLAYER_API FMultiplayerSessionSummary
+{
+	enum EFlags : uint8
+	{
+		//Has an owner and connection info, anything else can't be joined
+		Valid = 1 << 0,
+		Dedicated = 1 << 1,
+		JoinInProgress = 1 << 2,
+
+		//Found by the LAN search, has to be joined through the LAN interface
+		Lan = 1 << 3
+	};
+
+	TArray<FString> SessionIds;
+	TArray<FString> OwnerNames;
+	TArray<int32> MatchTypes;
+	TArray<int32> Regions;
+	TArray<int32> MapNames;
+	TArray<int32> BuildIds;
+	TArray<int32> SkillBuckets;
+	TArray<int32> Pings;
+	TArray<int32> OpenSlots;
+	TArray<int32> MaxSlots;
+
+	//Percent of the host's frame budget in use, INDEX_NONE when the host doesn't advertise it
+	TArray<int32> ServerLoads;
+	TArray<uint8> Flags;
+
+	//Interned attribute strings the MatchTypes, Regions and MapNames columns index into, 0 is always ""
+	TArray<FString> Strings;
+
+	FMultiplayerSessionSummary();
+
+	int32 Num() const { return SessionIds.Num(); }
+	void Reset();
+	void Reserve(int32 NumSessions);
+
+	//Adds every result of the search not already in the summary and keeps the search alive for Resolve, returns how many were added
+	int32 Append(const TSharedPtr<FOnlineSessionSearch>& Search, uint8 ExtraFlags = 0);
+
+	//Adds the results in order without keeping them, index i of the summary is index i of Results
+	void Append(const TArray<FOnlineSessionSearchResult>& Results);
+
+	//Full result behind a summary entry, null when it was built from results it doesn't own
+	const FOnlineSessionSearchResult* Resolve(int32 Index) const;
+
+	//Reorders every column so the lowest ping comes first
+	void SortByPing();
+
+	int32 FindSession(const FString& SessionId) const;
+
+	//Index of an interned string, INDEX_NONE if no session carries it
+	int32 FindString(const FString& Value) const;
+	const FString& GetString(int32 StringIndex) const { return Strings[StringIndex]; }
+	const FString& GetMatchType(int32 Index) const { return Strings[MatchTypes[Index]]; }
+
+	bool HasFlag(int32 Index, EFlags Flag) const { return (Flags[Index] & Flag) != 0; }
+
+private:
+
+	void Add(const FOnlineSessionSearchResult& Result, int32 SourceIndex, int32 ResultIndex, uint8 ExtraFlags);
+	int32 InternString(const FString& Value);
+
+	TMap<FString, int32> StringIndices;
+	TMap<FString, int32> SessionIndices;
+
+	//Searches the entries point back into, so the summary never copies a result
+	TArray<TSharedPtr<FOnlineSessionSearch>> Sources;
+	TArray<int32> SourceIndices;
+	TArray<int32> ResultIndices;
+};
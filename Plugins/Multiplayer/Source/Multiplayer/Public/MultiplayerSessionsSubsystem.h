@@ -4,21 +4,32 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "SessionSearchCache.h"
+#include "MultiplayerSessionAttributes.h"
+#include "MultiplayerSessionSummary.h"
+#include "SessionOperation.h"
+#include "MultiplayerNamedSession.h"
+#include "MultiplayerSessionPool.h"
 
 #include "MultiplayerSessionsSubsystem.generated.h"
 
+class FSessionSelector;
+
 /**
  * Declaring Custom Dynamic multicast delegate
  */
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnCreateSessionDelegate, bool, bWasSuccessful);
 DECLARE_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnFindSessionDelegate,const TArray<FOnlineSessionSearchResult>& SessionResults, bool bWasSuccessful);
+DECLARE_MULTICAST_DELEGATE_FourParams(FMultiplayerOnFindSessionPageDelegate, const TArray<FOnlineSessionSearchResult>& PageResults, int32 PageIndex, bool bIsFinalPage, bool bWasSuccessful);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FMultiplayerOnFindSessionSummaryDelegate, const FMultiplayerSessionSummary& Summary, bool bIsFinal, bool bWasSuccessful);
 DECLARE_MULTICAST_DELEGATE_OneParam(FMultiplayerOnJoinSessionDelegate, EOnJoinSessionCompleteResult::Type Result);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnStartSessionDelegate, bool, bWasSuccessful);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnDestroySessionDelegate, bool, bWasSuccessful);
 
-UCLASS()
+UCLASS(Config = Game)
 class MULTIPLAYER_API UMultiplayerSessionsSubsystem : public UGameInstanceSubsystem
 {
 	GENERATED_BODY()
@@ -27,55 +38,515 @@ public:
 
 	UMultiplayerSessionsSubsystem();
 
-	//To Be Called With Menu class
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	//To Be Called With Menu class, claims a warm session when the pool has one ready
 	void CreateSession(int32 NumPublicConnections = 4, FString MatchType = "FreeForAll");
-	void FindSessions(int32 MaxSearchResults);
-	void JoinSessions(const FOnlineSessionSearchResult& SearchResult);
+	void CreateSession(int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes);
+
+	//Hosts without a local player, for dedicated servers. The session isn't tied to anyone's presence
+	void CreateServerSession(int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes = FMultiplayerSessionAttributes());
+	void FindSessions(int32 MaxSearchResults, const FMultiplayerSessionAttributes& Filter = FMultiplayerSessionAttributes(), const FSessionOperationOptions& Options = FSessionOperationOptions());
+	void JoinSessions(const FOnlineSessionSearchResult& SearchResult, const FSessionOperationOptions& Options = FSessionOperationOptions());
+
+	//Scores the candidates once, joins the best one and falls back to the next best if that join fails
+	void JoinBestSession(const TArray<FOnlineSessionSearchResult>& Candidates, const FMultiplayerSessionAttributes& Desired = FMultiplayerSessionAttributes());
+	void JoinBestSession(const FMultiplayerSessionSummary& Summary, const FMultiplayerSessionAttributes& Desired = FMultiplayerSessionAttributes());
+
+	//Resolves the full result of one summary entry and joins it
+	void JoinSession(const FMultiplayerSessionSummary& Summary, int32 Index);
 	void DestroySessions();
 	void StartSession();
 
+	//Named Sessions, the calls above go to NAME_GameSession or the hosted session. Calls on different sessions run in parallel
+	void CreateSession(FName SessionName, int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes, bool bDedicated = false, const FSessionOperationOptions& Options = FSessionOperationOptions());
+	void JoinSession(FName SessionName, const FOnlineSessionSearchResult& SearchResult, const FSessionOperationOptions& Options = FSessionOperationOptions());
+	void StartSession(FName SessionName, const FSessionOperationOptions& Options = FSessionOperationOptions());
+	void DestroySession(FName SessionName, const FSessionOperationOptions& Options = FSessionOperationOptions());
+
+	//Pushes changed settings of a hosted session to the backend, warm sessions are made public through this
+	void UpdateSession(FName SessionName, int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes, bool bShouldAdvertise = true, const FSessionOperationOptions& Options = FSessionOperationOptions());
+
+	//Null until the session was first used
+	const FMultiplayerNamedSession* GetNamedSession(FName SessionName) const;
+	TArray<FName> GetNamedSessionNames() const;
+
+	//Callbacks of one session, bind before the first call on it
+	FMultiplayerOnSessionOperationDelegate& OnSessionOperation(FName SessionName);
+
+	//Session the host calls and the typed delegates go to. A claimed warm session keeps its pool name, AGameSession::SessionName has to follow it
+	FName GetHostedSessionName() const { return HostedSessionName; }
+
+	/**
+	 * Keeps sessions created but unlisted, so hosting only has to advertise and start one of them.
+	 * CreateSession claims a warm session when one is ready and the pool refills in the background.
+	 * @param PoolSize	Sessions kept warm, 0 uses WarmSessionPoolSize
+	 */
+	void StartSessionPool(int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes = FMultiplayerSessionAttributes(), int32 PoolSize = 0);
+
+	//Destroys every warm session that wasn't claimed, creates still on the wire are destroyed as they complete
+	void StopSessionPool();
+	bool IsSessionPoolRunning() const { return SessionPool.TargetSize > 0; }
+
+	//Opt-in through bWarmSessionPool, menus start the pool on setup when set
+	bool IsSessionPoolEnabled() const { return bWarmSessionPool; }
+
+	int32 GetNumWarmSessions() const { return SessionPool.ReadySessions.Num(); }
+	int32 GetNumWarmingSessions() const { return SessionPool.WarmingSessions.Num(); }
+	const FSessionPoolStats& GetSessionPoolStats() const { return SessionPool.Stats; }
+
+	//Pool size, refill latency and claim counters, also printed by "Multiplayer.Sessions.DumpPool"
+	void DumpSessionPool(FOutputDevice& Ar) const;
+
+	/**
+	 * Occupancy of the hosted session, reported by the game mode on every join and leave.
+	 * Reports are coalesced and pushed to the backend at most once every OccupancyUpdateIntervalSeconds,
+	 * so a burst of joins costs one update.
+	 * @param ServerLoad	Percent of the server's frame budget in use, INDEX_NONE leaves it out
+	 */
+	void ReportSessionOccupancy(int32 NumPlayers, int32 ServerLoad = INDEX_NONE);
+
+	/**
+	 * Searches in growing pages and hands every page to MultiplayerOnFindSessionPageDelegate as soon as it arrives.
+	 * With bSearchLanAndOnline the LAN search runs next to the first page and its sessions go out as a page of their own.
+	 * @param PageSize				Results asked for by the first page, every next page doubles it
+	 * @param StopAfterAcceptable	Stops once this many acceptable sessions were found, 0 searches up to MaxSearchResults
+	 * @param IsAcceptable			Decides which results count towards StopAfterAcceptable, every result counts when unset
+	 */
+	void FindSessionsStreaming(int32 MaxSearchResults, const FMultiplayerSessionAttributes& Filter, int32 PageSize = 50, int32 StopAfterAcceptable = 0, TFunction<bool(const FOnlineSessionSearchResult&)> IsAcceptable = nullptr);
+
+	/**
+	 * Keeps a low priority search warm in the search cache so a join can pick a session without waiting on the backend.
+	 * Refreshes only go out while the operation queue is idle, so they never hold up anything the player asked for.
+	 * @param IntervalSeconds	Seconds between refreshes, 0 uses PrefetchIntervalSeconds
+	 */
+	void StartPrefetch(int32 MaxSearchResults, const FMultiplayerSessionAttributes& Filter = FMultiplayerSessionAttributes(), float IntervalSeconds = 0.0f);
+	void StopPrefetch();
+	bool IsPrefetching() const { return PrefetchTickHandle.IsValid(); }
+
+	//Opt-in through bPrefetchSessions, menus start a prefetch on setup when set
+	bool IsPrefetchEnabled() const { return bPrefetchSessions; }
+
+	//Joins the best of the prefetched sessions, false when none is warm enough or matches Desired and the caller has to search
+	bool JoinBestPrefetchedSession(const FMultiplayerSessionAttributes& Desired = FMultiplayerSessionAttributes());
+
+	//Address to travel to for a session this client joined
+	bool GetResolvedConnectString(FString& OutConnectString, FName SessionName = NAME_GameSession) const;
+
+	//True when calls go to the in-process mock instead of the platform backend
+	bool IsUsingMockSessionBackend() const { return MockSessionBackend.IsValid(); }
+
+	//Backend calls queued behind the ones currently on the wire, over every lane
+	int32 GetNumPendingOperations() const;
+	bool HasOperationInFlight() const;
+
+	//Backend completion delegates still bound, anything above zero while idle is a leaked handle
+	int32 GetNumBoundBackendDelegates() const;
+
+	//Mock backend calls whose completion has not fired yet, always 0 on a platform backend
+	int32 GetNumPendingBackendCalls() const;
+
+	//Summary of the last search, or of every page so far while streaming
+	const FMultiplayerSessionSummary& GetSessionSummary() const { return SessionSummary; }
+
+	//Drops every cached search so the next FindSessions goes to the backend
+	void InvalidateSearchCache();
+	const FSessionSearchCacheStats& GetSearchCacheStats() const { return SearchCache.GetStats(); }
 
 	FMultiplayerOnCreateSessionDelegate MultiplayerOnCreateSessionDelegate;
 	FMultiplayerOnFindSessionDelegate MultiplayerOnFindSessionDelegate;
+	FMultiplayerOnFindSessionPageDelegate MultiplayerOnFindSessionPageDelegate;
+
+	//Same searches as above as a struct of arrays, cheaper for UI that lists thousands of sessions
+	FMultiplayerOnFindSessionSummaryDelegate MultiplayerOnFindSessionSummaryDelegate;
 	FMultiplayerOnJoinSessionDelegate MultiplayerOnJoinSessionDelegate;
 	FMultiplayerOnStartSessionDelegate MultiplayerOnStartSessionDelegate;
 	FMultiplayerOnDestroySessionDelegate MultiplayerOnDestroySessionDelegate;
 
+	//Every operation on every named session, the typed delegates above only fire for NAME_GameSession and the hosted session
+	FMultiplayerOnSessionOperationDelegate MultiplayerOnSessionOperationDelegate;
+
 private:
 
 	IOnlineSessionPtr SessionInterface;
-	TSharedPtr<FOnlineSessionSettings> LastSessionSettings;
+
+	//NULL subsystem's interface for LAN searches next to the platform backend, unset when the platform backend is NULL
+	IOnlineSessionPtr LanSessionInterface;
+	TSharedPtr<class FOnlineSessionMock, ESPMode::ThreadSafe> MockSessionBackend;
 	TSharedPtr<FOnlineSessionSearch> LastSessionSearch;
 
-	//Delegates
-	FOnCreateSessionCompleteDelegate CreateSessionCompleteDelegate;
+	//Delegates, session completions are bound per lane with the lane's session name as payload
 	FOnFindSessionsCompleteDelegate FindSessionsCompleteDelegate;
-	FOnJoinSessionCompleteDelegate JoinSessionCompleteDelegate;
-	FOnDestroySessionCompleteDelegate DestroySessionCompleteDelegate;
-	FOnStartSessionCompleteDelegate StartSessionCompleteDelegate;
+	FOnFindSessionsCompleteDelegate LanFindSessionsCompleteDelegate;
+	FDelegateHandle LanFindSessionsCompleteDelegateHandle;
+
+	//Operation Queue, one lane per named session plus one for searches, each lane has one backend call on the wire at a time
+	TMap<FName, TUniquePtr<FMultiplayerNamedSession>> NamedSessions;
+	FSessionOperationLane SearchLane;
+	bool bPumpingOperations = false;
+
+	FName HostedSessionName = NAME_GameSession;
+
+	//Warm Session Pool
+	struct FSessionPool
+	{
+		int32 TargetSize = 0;
+		int32 NumPublicConnections = 0;
+		FMultiplayerSessionAttributes Attributes;
+		int32 NextSessionIndex = 0;
+
+		//Created and unlisted, oldest first
+		TArray<FName> ReadySessions;
+
+		//Creates on the wire with the time they were asked for
+		TMap<FName, double> WarmingSessions;
+
+		//Claimed session waiting on its update, a failed claim falls back to a regular create
+		FName ClaimingSession;
+		FSessionPoolStats Stats;
+	};
+	FSessionPool SessionPool;
+	FTSTicker::FDelegateHandle PoolRetryTickHandle;
+
+	UPROPERTY(Config)
+	bool bWarmSessionPool = false;
+
+	UPROPERTY(Config)
+	int32 WarmSessionPoolSize = 1;
+
+	//Seconds before failed warm creates are asked for again
+	UPROPERTY(Config)
+	float WarmSessionRetrySeconds = 5.0f;
+
+	//Session Occupancy, what the game mode reported last and what the backend was told last
+	struct FSessionOccupancy
+	{
+		int32 NumPlayers = INDEX_NONE;
+		int32 ServerLoad = INDEX_NONE;
+		int32 PushedPlayers = INDEX_NONE;
+		int32 PushedLoad = INDEX_NONE;
+		double LastPushTime = 0.0;
+	};
+	FSessionOccupancy Occupancy;
+	FTSTicker::FDelegateHandle OccupancyTickHandle;
+
+	//Seconds between occupancy updates of the hosted session, everything reported in between goes out together
+	UPROPERTY(Config)
+	float OccupancyUpdateIntervalSeconds = 2.0f;
+
+	//Load changes smaller than this many percent aren't worth an update on their own
+	UPROPERTY(Config)
+	int32 ServerLoadUpdateThreshold = 10;
+
+	//Deadlines and Retries, checked on every tick of the deadline ticker
+	FTSTicker::FDelegateHandle DeadlineTickHandle;
+
+	//Seconds an operation may take before it fails, retries included. Callers override it per call, 0 never times out
+	UPROPERTY(Config)
+	float OperationTimeoutSeconds = 30.0f;
+
+	//Seconds one backend call may take before it is abandoned and retried, 0 only bounds the whole operation
+	UPROPERTY(Config)
+	float AttemptTimeoutSeconds = 0.0f;
+
+	UPROPERTY(Config)
+	int32 MaxOperationRetries = 2;
+
+	//Backoff before retry N is RetryBackoffSeconds * RetryBackoffMultiplier^N, capped, minus up to RetryBackoffJitter of itself
+	UPROPERTY(Config)
+	float RetryBackoffSeconds = 0.25f;
+
+	UPROPERTY(Config)
+	float RetryBackoffMultiplier = 2.0f;
+
+	UPROPERTY(Config)
+	float MaxRetryBackoffSeconds = 4.0f;
+
+	UPROPERTY(Config)
+	float RetryBackoffJitter = 0.25f;
+
+	//Finds slower than HedgeFindPercentile of past finds send a second request and take whichever answers first
+	UPROPERTY(Config)
+	bool bHedgeFindSessions = false;
+
+	UPROPERTY(Config)
+	float HedgeFindPercentile = 95.0f;
+
+	//Finds measured before the percentile is trusted
+	UPROPERTY(Config)
+	int32 MinHedgeSamples = 20;
+
+	//Dedicated Server Hosting, also switched on with -HostSession
+	UPROPERTY(Config)
+	bool bHostSessionOnDedicatedServer = false;
+
+	//Overridden with -SessionConnections=
+	UPROPERTY(Config)
+	int32 DedicatedServerConnections = 16;
 
-	//Delegate Handles
-	FDelegateHandle CreateSessionCompleteDelegateHandle;
-	FDelegateHandle FindSessionsCompleteDelegateHandle;
-	FDelegateHandle JoinSessionCompleteDelegateHandle;
-	FDelegateHandle DestroySessionCompleteDelegateHandle;
-	FDelegateHandle StartSessionCompleteDelegateHandle;
+	//Overridden with -SessionMatchType=
+	UPROPERTY(Config)
+	FString DedicatedServerMatchType = TEXT("FreeForAll");
 
+	//Searches leave out the presence filter so they find dedicated servers, which don't advertise through presence
+	UPROPERTY(Config)
+	bool bSearchDedicatedServers = false;
 
-	bool bCreateSessionOnDestroy = false;
-	int32 LastNumPublicConnections;
-	FString LastMatchType;
+	//Stamped on created sessions and searches that don't ask for a build themselves
+	UPROPERTY(Config)
+	int32 SessionBuildId = 1;
 
+	//Region advertised by created sessions, empty leaves it out
+	UPROPERTY(Config)
+	FString SessionRegion;
+
+	//Search Cache
+	FSessionSearchCache SearchCache;
+	FString LastSearchKey;
+	FMultiplayerSessionAttributes LastSearchFilter;
+	double LastSearchStartTime = 0.0;
+	bool bSearchInProgress = false;
+	bool bBroadcastSearchResults = true;
+
+	//Set false to always go to the backend
+	UPROPERTY(Config)
+	bool bEnableSearchCache = true;
+
+	//Seconds a cached search is returned without refreshing it
+	UPROPERTY(Config)
+	float SearchCacheTTL = 15.0f;
+
+	//Seconds a cached search is still returned while a background refresh runs
+	UPROPERTY(Config)
+	float SearchCacheStaleTTL = 120.0f;
+
+	//Session Summary
+	FMultiplayerSessionSummary SessionSummary;
+
+	//Best Session Selection
+	TArray<FOnlineSessionSearchResult> JoinCandidates;
+	int32 JoinCandidateIndex = INDEX_NONE;
+
+	//Candidates kept for fallback joins after the best one fails
+	UPROPERTY(Config)
+	int32 MaxJoinAttempts = 3;
+
+	UPROPERTY(Config)
+	float SelectionPingWeight = 1.0f;
+
+	UPROPERTY(Config)
+	float SelectionOpenConnectionsWeight = 0.5f;
+
+	UPROPERTY(Config)
+	float SelectionAttributeMatchWeight = 0.75f;
+
+	UPROPERTY(Config)
+	float SelectionHostQualityWeight = 0.25f;
+
+	UPROPERTY(Config)
+	int32 SelectionMaxAcceptablePingMs = 250;
+
+	//Mock Session Backend, also switched on with -MockSessionBackend
+	UPROPERTY(Config)
+	bool bUseMockSessionBackend = false;
+
+	UPROPERTY(Config)
+	int32 MockSessionCount = 2000;
+
+	UPROPERTY(Config)
+	float MockLatencyMs = 80.0f;
+
+	UPROPERTY(Config)
+	float MockJitterMs = 40.0f;
+
+	//Chance (0..1) that a mock backend call fails
+	UPROPERTY(Config)
+	float MockFailureRate = 0.0f;
+
+	UPROPERTY(Config)
+	int32 MockRandomSeed = 0;
+
+	//Synthetic hosts are spread over this many loopback ports
+	UPROPERTY(Config)
+	int32 MockHostPorts = 1;
+
+	//Every mock host port gets a loopback stand-in answering ping probes
+	UPROPERTY(Config)
+	bool bMockProbeResponders = false;
+
+	//Ping Probing
+	TSharedPtr<class FSessionPingProber> CandidateProber;
+	TSharedPtr<class FSessionPingResponder> ProbeResponder;
+
+	//Measures the round trip to the best candidates before joining and re-ranks them on it
+	UPROPERTY(Config)
+	bool bProbeCandidatesBeforeJoin = false;
+
+	//Best ranked candidates probed, never fewer than MaxJoinAttempts
+	UPROPERTY(Config)
+	int32 ProbeCandidateCount = 8;
+
+	//The join goes out after this long even if some candidates never answered
+	UPROPERTY(Config)
+	float ProbeBudgetMs = 250.0f;
+
+	//Hosts answer probes on their game port plus this offset
+	UPROPERTY(Config)
+	int32 SessionProbePortOffset = 100;
+
+	//Created sessions answer probes of searching clients
+	UPROPERTY(Config)
+	bool bAnswerSessionProbes = false;
+
+	//LAN Fan-out
+	struct FFanOutSearch
+	{
+		bool bActive = false;
+		int32 NumPending = 0;
+		int32 PageIndex = 0;
+		bool bAnySucceeded = false;
+		FMultiplayerSessionAttributes Filter;
+		TSharedPtr<FOnlineSessionSearch> LanSearch;
+	};
+	FFanOutSearch FanOutSearch;
+
+	//Sessions found on LAN, joins of these go through LanSessionInterface
+	TSet<FString> LanSessionIds;
+
+	//FindSessions and FindSessionsStreaming also search LAN through the NULL subsystem, both run at once and are merged
+	UPROPERTY(Config)
+	bool bSearchLanAndOnline = false;
+
+	//Created sessions are also advertised on LAN so fan-out searches on other machines find them
+	UPROPERTY(Config)
+	bool bAdvertiseOnLan = false;
+
+	//Background Prefetch
+	FTSTicker::FDelegateHandle PrefetchTickHandle;
+	FString PrefetchSearchKey;
+	FMultiplayerSessionAttributes PrefetchFilter;
+	int32 PrefetchMaxResults = 0;
+
+	UPROPERTY(Config)
+	bool bPrefetchSessions = false;
+
+	//Seconds between background refreshes, keep it below SearchCacheTTL so joins see fresh results
+	UPROPERTY(Config)
+	float PrefetchIntervalSeconds = 10.0f;
+
+	//Streaming Search
+	struct FStreamingSearch
+	{
+		bool bActive = false;
+		int32 MaxSearchResults = 0;
+		int32 PageSize = 0;
+		int32 RequestedResults = 0;
+		int32 StopAfterAcceptable = 0;
+		int32 PageIndex = 0;
+		int32 NumAcceptable = 0;
+
+		//Online pages ran out, and the LAN search running next to them with bSearchLanAndOnline hasn't answered yet
+		bool bOnlineDone = false;
+		bool bLanPending = false;
+
+		//Search the current page waits on, completions of any other search are none of this stream's business
+		TSharedPtr<FOnlineSessionSearch> PageSearch;
+		FMultiplayerSessionAttributes Filter;
+		TFunction<bool(const FOnlineSessionSearchResult&)> IsAcceptable;
+	};
+	FStreamingSearch StreamingSearch;
 
 
 protected:
 
-	//CallBack Functions for delegates
-	void OnCreateSessionComplete(FName SessionName, bool bWasSuccessful);
+	FMultiplayerNamedSession& FindOrAddNamedSession(FName SessionName);
+	FSessionOperationLane& GetLane(const FSessionOperation& Operation);
+	FSessionOperationLane* FindLane(FName SessionName);
+
+	void EnqueueOperation(FSessionOperation&& Operation);
+	void PumpOperations();
+	void ExecuteOperation(FSessionOperationLane& Lane);
+	void CompleteOperation(FSessionOperationLane& Lane, bool bWasSuccessful);
+	void BroadcastOperationFailure(const FSessionOperation& Operation);
+
+	void ApplyOperationOptions(FSessionOperation& Operation, const FSessionOperationOptions& Options) const;
+	void MergeSearchCaller(FSessionOperation& Search, const FSessionOperation& Caller);
+	bool TickOperationDeadlines(float DeltaTime);
+
+	//Drops the backend call on the wire and fails it through its completion callback, which may still retry it
+	void AbandonOperation(FSessionOperationLane& Lane, bool bCancelled);
+
+	//Puts a failed operation back at the front of its lane after its backoff, false when it is out of attempts or time
+	bool RetryOperation(FSessionOperationLane& Lane);
+	void HedgeFindSessions(double Now);
+
+	//Updates the session's state and fires the typed, subsystem wide and per session delegates
+	void NotifySessionOperation(FName SessionName, ESessionOperation Type, bool bWasSuccessful);
+
+	//Backend Calls
+	void ExecuteCreateSession(FSessionOperationLane& Lane);
+	void ExecuteFindSessions(FSessionOperationLane& Lane);
+	void ExecuteJoinSession(FSessionOperationLane& Lane);
+	void ExecuteDestroySession(FSessionOperationLane& Lane);
+	void ExecuteStartSession(FSessionOperationLane& Lane);
+	void ExecuteUpdateSession(FSessionOperationLane& Lane);
+
+	//False when no warm session is ready and the caller has to create one
+	bool ClaimWarmSession(int32 NumPublicConnections, const FMultiplayerSessionAttributes& Attributes);
+	void RefillSessionPool();
+	void OnWarmSessionCreated(FName SessionName, bool bWasSuccessful);
+	bool TickPoolRetry(float DeltaTime);
+
+	//LAN mirror and probe responder of the session this process hosts, once it is created or claimed
+	void OnHostedSessionReady();
+
+	//Queues an occupancy update now or arms the ticker for when the interval is up, nothing when the backend is current
+	void FlushSessionOccupancy();
+	bool TickOccupancyUpdate(float DeltaTime);
+
+	//Fills in the build id and region this client advertises when the caller left them unset
+	FMultiplayerSessionAttributes ApplySessionDefaults(const FMultiplayerSessionAttributes& Attributes) const;
+	TSharedPtr<FOnlineSessionSearch> MakeSessionSearch(int32 MaxSearchResults, const FMultiplayerSessionAttributes& Filter) const;
+	void RequestNextSearchPage();
+	//NumBackendResults counts what the backend returned before local filtering, INDEX_NONE takes the page's own count
+	void HandleSearchPage(const TSharedPtr<FOnlineSessionSearch>& Search, bool bWasSuccessful, int32 NumBackendResults = INDEX_NONE, bool bFromLan = false);
+	bool IsStreamingPage(const FSessionOperation& Operation) const;
+
+	//Interface holding the named session, LAN joins live on the LAN interface
+	IOnlineSessionPtr GetSessionInterfaceFor(FName SessionName) const;
+	bool IsLanOnlyBackend() const;
+	int32 GetLocalControllerId() const;
+
+	//Net id of the first local player, null on dedicated servers and before a player exists
+	FUniqueNetIdPtr GetLocalUserId() const;
+
+	//Returns false when the LAN interface refused the search
+	bool StartLanSearch(int32 MaxSearchResults, const FMultiplayerSessionAttributes& Filter);
+	void HandleFanOutResult(const TSharedPtr<FOnlineSessionSearch>& Search, bool bWasSuccessful, bool bFromLan);
+	void AdvertiseOnLan();
+	void OnLanFindSessionsComplete(bool bWasSuccessful);
+
+	//Rebuilds the summary from a finished search and broadcasts both find delegates
+	void BroadcastFoundSessions(const TSharedPtr<FOnlineSessionSearch>& Search, bool bWasSuccessful);
+
+	//False when no candidate ranked, which is broadcast as SessionDoesNotExist unless the caller falls back on its own
+	bool JoinRankedCandidates(const FMultiplayerSessionSummary& Summary, const FMultiplayerSessionAttributes& Desired, TFunctionRef<const FOnlineSessionSearchResult*(int32)> ResolveCandidate, bool bBroadcastIfNoneRanked = true);
+
+	//False when none of the candidates has an address that can be probed, the join then goes out on backend pings
+	bool ProbeJoinCandidates(const FSessionSelector& Selector);
+	void OnJoinCandidatesProbed(const FSessionSelector& Selector, const TArray<int32>& ProbedCandidates, const TArray<int32>& RttMs);
+	void QueueSessionSearch(const TSharedPtr<FOnlineSessionSearch>& NewSearch, const FString& SearchKey, const FMultiplayerSessionAttributes& Filter, bool bBroadcastResults, const FSessionOperationOptions& Options = FSessionOperationOptions(), bool bCacheRefresh = false);
+	bool TickPrefetch(float DeltaTime);
+
+	//CallBack Functions for delegates, every lane waiting on the same call type is called and skips other sessions
+	void OnCreateSessionComplete(FName SessionName, bool bWasSuccessful, FName LaneName);
 	void OnFindSessionsComplete(bool bWasSuccessful);
-	void OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
-	void OnDestroySessionComplete(FName SessionName, bool bWasSuccessful);
-	void OnStartSessionComplete(FName SessionName, bool bWasSuccessful);
+	void FinishFindSessions(bool bWasSuccessful);
+	void OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result, FName LaneName);
+	void OnDestroySessionComplete(FName SessionName, bool bWasSuccessful, FName LaneName);
+	void OnStartSessionComplete(FName SessionName, bool bWasSuccessful, FName LaneName);
+	void OnUpdateSessionComplete(FName SessionName, bool bWasSuccessful, FName LaneName);
 
 
 };
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Lock free log-linear latency histogram in the style of HdrHistogram.
+ * Values are microseconds, every power of two is split into 16 buckets so any percentile is within ~6% of the real value.
+ */
+class MULTIPLAYER_API FSessionLatencyHistogram
+{
+public:
+
+	static constexpr int32 SubBucketBits = 4;
+	static constexpr int32 SubBucketCount = 1 << SubBucketBits;
+	static constexpr int32 MaxShift = 32;
+	static constexpr int32 NumBuckets = 2 * SubBucketCount + MaxShift * SubBucketCount;
+
+	FSessionLatencyHistogram();
+
+	//Safe to call from any thread
+	void Record(uint64 ValueMicroseconds);
+	void Reset();
+
+	uint64 GetCount() const { return Count.load(std::memory_order_relaxed); }
+	uint64 GetMax() const { return MaxValue.load(std::memory_order_relaxed); }
+	double GetMean() const;
+
+	//Upper edge of the bucket holding the given percentile (0..100)
+	uint64 GetPercentile(double Percentile) const;
+
+	uint64 GetBucketCount(int32 BucketIndex) const { return Buckets[BucketIndex].load(std::memory_order_relaxed); }
+	static int32 GetBucketIndex(uint64 Value);
+	static uint64 GetBucketLowerBound(int32 BucketIndex);
+	static uint64 GetBucketUpperBound(int32 BucketIndex);
+
+private:
+
+	std::atomic<uint64> Buckets[NumBuckets];
+	std::atomic<uint64> Count;
+	std::atomic<uint64> Sum;
+	std::atomic<uint64> MaxValue;
+};
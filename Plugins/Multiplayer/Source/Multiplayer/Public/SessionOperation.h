@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MultiplayerSessionAttributes.h"
+#include <atomic>
+
+class FOnlineSessionSearch;
+class FOnlineSessionSearchResult;
+
+enum class ESessionOperation : uint8
+{
+	Create,
+	Find,
+	Join,
+	Start,
+	Destroy,
+	Update,
+
+	Count
+};
+
+inline const TCHAR* LexToString(ESessionOperation Operation)
+{
+	switch (Operation)
+	{
+	case ESessionOperation::Create:		return TEXT("Create");
+	case ESessionOperation::Find:		return TEXT("Find");
+	case ESessionOperation::Join:		return TEXT("Join");
+	case ESessionOperation::Start:		return TEXT("Start");
+	case ESessionOperation::Destroy:	return TEXT("Destroy");
+	case ESessionOperation::Update:		return TEXT("Update");
+	default:							return TEXT("Unknown");
+	}
+}
+
+/**
+ * Lets a caller abandon session operations it started. Safe to cancel from any thread, the subsystem notices on its next tick
+ */
+class FSessionCancellationToken
+{
+public:
+
+	void Cancel() { bCancelled.store(true, std::memory_order_relaxed); }
+	bool IsCancelled() const { return bCancelled.load(std::memory_order_relaxed); }
+
+private:
+
+	std::atomic<bool> bCancelled{ false };
+};
+
+/**
+ * How long a caller is willing to wait on an operation and how it can give up on it
+ */
+struct FSessionOperationOptions
+{
+	//Seconds until the operation fails, retries included. 0 uses the subsystem's OperationTimeoutSeconds, negative never times out
+	float TimeoutSeconds = 0.0f;
+
+	TSharedPtr<FSessionCancellationToken, ESPMode::ThreadSafe> CancellationToken;
+};
+
+/**
+ * One backend call waiting in the subsystem's operation queue, with everything needed to issue it later
+ */
+struct FSessionOperation
+{
+	ESessionOperation Type = ESessionOperation::Find;
+	FName SessionName = NAME_GameSession;
+
+	//Create and Update, Attributes double as the filter of a Find
+	int32 NumPublicConnections = 0;
+	FMultiplayerSessionAttributes Attributes;
+
+	//Create and Update, warm pool sessions are created unlisted
+	bool bAdvertise = true;
+
+	//Create, hosted under the server's identity instead of a local player's
+	bool bDedicated = false;
+
+	//Update, pushes the occupancy the host reported last when it goes out and leaves everything else as it is
+	bool bPushOccupancy = false;
+
+	//Find
+	TSharedPtr<FOnlineSessionSearch> Search;
+	FString SearchKey;
+	bool bBroadcastResults = true;
+
+	//Find, refreshes a stale cache entry a caller was just served. Only these count as cache refreshes
+	bool bCacheRefresh = false;
+
+	//Find, second request sent when the first one is slower than usual. Whichever answers first wins
+	TSharedPtr<FOnlineSessionSearch> HedgeSearch;
+	bool bHedged = false;
+
+	//Join
+	TSharedPtr<FOnlineSessionSearchResult> SearchResult;
+
+	//Time the caller asked for it, latencies are measured call-to-callback
+	double EnqueuedTime = 0.0;
+
+	//Absolute FPlatformTime, 0 until the queue stamps the default timeout on it
+	double Deadline = 0.0;
+	TSharedPtr<FSessionCancellationToken, ESPMode::ThreadSafe> CancellationToken;
+
+	//Retries wait in the queue until NotBefore, their backoff
+	int32 Attempt = 0;
+	double NotBefore = 0.0;
+	double AttemptStartTime = 0.0;
+
+	//Chained steps (create after destroy) are failed without a backend call when the step before them failed
+	bool bRequiresPreviousSuccess = false;
+
+	bool IsCancelled() const { return CancellationToken.IsValid() && CancellationToken->IsCancelled(); }
+};
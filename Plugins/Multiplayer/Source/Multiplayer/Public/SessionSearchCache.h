@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FOnlineSessionSearch;
+
+/**
+ * Counters for the session search cache
+ */
+struct MULTIPLAYER_API FSessionSearchCacheStats
+{
+	//Lookups of FindSessions callers only
+	int32 Hits = 0;
+	int32 StaleHits = 0;
+	int32 Misses = 0;
+
+	//Background refreshes of stale entries that came back, other searches aren't counted
+	int32 Refreshes = 0;
+
+	//Seconds taken by the backend to answer a refresh
+	double LastRefreshLatency = 0.0;
+	double TotalRefreshLatency = 0.0;
+
+	double GetAverageRefreshLatency() const
+	{
+		return Refreshes > 0 ? TotalRefreshLatency / Refreshes : 0.0;
+	}
+};
+
+/**
+ * Keeps finished session searches keyed on their query parameters.
+ * Entries younger than the TTL are fresh, entries younger than the stale TTL can still be served while a refresh runs.
+ */
+class MULTIPLAYER_API FSessionSearchCache
+{
+public:
+
+	enum class ELookupResult : uint8
+	{
+		Miss,
+		Fresh,
+		Stale
+	};
+
+	//Builds a key out of everything that changes what the backend returns
+	static FString MakeKey(const FOnlineSessionSearch& Search);
+
+	ELookupResult Find(const FString& Key, double Now, float TTL, float StaleTTL, TSharedPtr<FOnlineSessionSearch>& OutSearch);
+
+	//Looks at an entry without evicting it or touching the stats, for lookups of the subsystem's own rather than a caller's
+	bool Peek(const FString& Key, double Now, TSharedPtr<FOnlineSessionSearch>& OutSearch, double& OutAge) const;
+	//NumBackendResults is what the backend returned before local filtering, INDEX_NONE when nothing was filtered
+	void Store(const FString& Key, const TSharedPtr<FOnlineSessionSearch>& Search, double Now, int32 NumBackendResults = INDEX_NONE);
+
+	//Results the backend returned for a cached search, INDEX_NONE when it isn't cached
+	int32 GetNumBackendResults(const FString& Key) const;
+	void RecordRefresh(double Latency);
+	void Invalidate();
+
+	const FSessionSearchCacheStats& GetStats() const { return Stats; }
+
+private:
+
+	struct FEntry
+	{
+		TSharedPtr<FOnlineSessionSearch> Search;
+		double StoredTime = 0.0;
+		int32 NumBackendResults = 0;
+	};
+
+	TMap<FString, FEntry> Entries;
+	FSessionSearchCacheStats Stats;
+};
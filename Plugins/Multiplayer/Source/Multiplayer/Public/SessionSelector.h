@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MultiplayerSessionAttributes.h"
+#include "MultiplayerSessionSummary.h"
+
+/**
+ * How much each part of a candidate's score counts, all parts are normalized to 0..1 first
+ */
+struct MULTIPLAYER_API FSessionSelectionWeights
+{
+	float Ping = 1.0f;
+	float OpenConnections = 0.5f;
+	float AttributeMatch = 0.75f;
+	float HostQuality = 0.25f;
+
+	//Pings at or above this score zero
+	int32 MaxAcceptablePingMs = 250;
+};
+
+/**
+ * Scores a session summary once and hands back the best candidates to join, best first
+ */
+class MULTIPLAYER_API FSessionSelector
+{
+public:
+
+	FSessionSelector(const FMultiplayerSessionAttributes& InDesired, const FSessionSelectionWeights& InWeights);
+
+	//Negative score means the session can't be joined at all (full, wrong match type or build)
+	float Score(const FMultiplayerSessionSummary& Summary, int32 Index) const;
+
+	//Summary indices of the best joinable sessions, at most MaxCandidates of them
+	TArray<int32> Rank(const FMultiplayerSessionSummary& Summary, int32 MaxCandidates) const;
+
+private:
+
+	//Desired strings looked up in the summary's string table once per ranking
+	struct FInternedDesired
+	{
+		int32 MatchType = INDEX_NONE;
+		int32 Region = INDEX_NONE;
+		int32 MapName = INDEX_NONE;
+	};
+
+	FInternedDesired Intern(const FMultiplayerSessionSummary& Summary) const;
+	float Score(const FMultiplayerSessionSummary& Summary, int32 Index, const FInternedDesired& Interned) const;
+
+	FMultiplayerSessionAttributes Desired;
+	FSessionSelectionWeights Weights;
+};
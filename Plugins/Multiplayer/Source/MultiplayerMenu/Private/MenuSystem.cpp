@@ -4,6 +4,7 @@
 #include "MenuSystem.h"
 #include "Components/Button.h"
 #include "MultiplayerSessionsSubsystem.h"
+#include "MultiplayerSessionAttributes.h"
 #include "OnlineSessionSettings.h"
 #include "OnlineSubsystem.h"
 
@@ -70,10 +71,26 @@ void UMenuSystem :: MenuSetup(int32 INumConnections, FString IMatchType, FString
     if (MultiplayerSessionsSubsystem)
     {
         MultiplayerSessionsSubsystem->MultiplayerOnCreateSessionDelegate.AddDynamic(this, &ThisClass::OnCreateSession);
-        MultiplayerSessionsSubsystem->MultiplayerOnFindSessionDelegate.AddUObject(this, &ThisClass::OnFindSession);
+        MultiplayerSessionsSubsystem->MultiplayerOnFindSessionSummaryDelegate.AddUObject(this, &ThisClass::OnFindSessionSummary);
         MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionDelegate.AddUObject(this, &ThisClass::OnJoinSession);
         MultiplayerSessionsSubsystem->MultiplayerOnStartSessionDelegate.AddDynamic(this, &ThisClass::OnStartSession);
         MultiplayerSessionsSubsystem->MultiplayerOnDestroySessionDelegate.AddDynamic(this, &ThisClass::OnDestroySession);
+
+        //Searching while the player looks at the menu takes the search off the Join click
+        if (MultiplayerSessionsSubsystem->IsPrefetchEnabled())
+        {
+            FMultiplayerSessionAttributes Filter;
+            Filter.MatchType = MatchType;
+            MultiplayerSessionsSubsystem->StartPrefetch(PrefetchSearchResults, Filter);
+        }
+
+        //Host then only has to list and start a session that already exists
+        if (MultiplayerSessionsSubsystem->IsSessionPoolEnabled())
+        {
+            FMultiplayerSessionAttributes Attributes;
+            Attributes.MatchType = MatchType;
+            MultiplayerSessionsSubsystem->StartSessionPool(NumConnections, Attributes);
+        }
     }
 }
 
@@ -88,6 +105,7 @@ void UMenuSystem::HostButtonClicked()
 
     if (MultiplayerSessionsSubsystem)
     {
+        MultiplayerSessionsSubsystem->StopPrefetch();
         MultiplayerSessionsSubsystem->CreateSession(NumConnections,MatchType);
     }
 }
@@ -102,12 +120,38 @@ void UMenuSystem::JoinButtonClicked()
     //UE_LOG(LogTemp, Warning, TEXT("JOIN BUTTON CLICKED"));
     if (MultiplayerSessionsSubsystem)
     {
-        MultiplayerSessionsSubsystem->FindSessions(10000);
+        //Joining someone else, the warm sessions would only sit there hosting nothing
+        MultiplayerSessionsSubsystem->StopSessionPool();
+
+        //Warm prefetched results skip the search entirely
+        FMultiplayerSessionAttributes Desired;
+        Desired.MatchType = MatchType;
+        //Set first, a join that fails right away reports back before this returns
+        bJoiningPrefetched = true;
+        if (!MultiplayerSessionsSubsystem->JoinBestPrefetchedSession(Desired))
+        {
+            bJoiningPrefetched = false;
+            SearchForSessions();
+        }
     }
 }
 
+void UMenuSystem::SearchForSessions()
+{
+    //Backend filters on match type, stop once there are enough sessions to pick the best from
+    FMultiplayerSessionAttributes Filter;
+    Filter.MatchType = MatchType;
+    MultiplayerSessionsSubsystem->FindSessionsStreaming(10000, Filter, SearchPageSize, NumSessionsToRank);
+}
+
 void UMenuSystem::Menuteardown()
 {
+    if (MultiplayerSessionsSubsystem)
+    {
+        MultiplayerSessionsSubsystem->StopPrefetch();
+        MultiplayerSessionsSubsystem->StopSessionPool();
+    }
+
     RemoveFromParent();
     UWorld* World = GetWorld();
     if (World)
@@ -157,35 +201,38 @@ void UMenuSystem::OnJoinSession(EOnJoinSessionCompleteResult::Type Result)
     {
         GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Green, FString("JoinButtonClicked7"));
     }
-    IOnlineSubsystem* OnlineSubsystem = IOnlineSubsystem::Get();
-    if (OnlineSubsystem)
+    //Resolved through the subsystem so the mock backend hands out its own addresses
+    FString IPAddress;
+    if (MultiplayerSessionsSubsystem && Result == EOnJoinSessionCompleteResult::Success && MultiplayerSessionsSubsystem->GetResolvedConnectString(IPAddress))
     {
-        IOnlineSessionPtr SessionInterface = OnlineSubsystem->GetSessionInterface();
-        if (SessionInterface.IsValid())
-        {
-            FString IPAddress;
-            SessionInterface->GetResolvedConnectString(NAME_GameSession, IPAddress);
-
-            APlayerController* PlayerController = GetGameInstance()->GetFirstLocalPlayerController();
+        APlayerController* PlayerController = GetGameInstance()->GetFirstLocalPlayerController();
 
-            if (PlayerController)
+        if (PlayerController)
+        {
+            PlayerController->ClientTravel(IPAddress, ETravelType::TRAVEL_Absolute);
+            if (GEngine)
             {
-                PlayerController->ClientTravel(IPAddress, ETravelType::TRAVEL_Absolute);
-                if (GEngine)
-                {
-                    GEngine->AddOnScreenDebugMessage
-                    (
-                        -1,
-                        15.0f,
-                        FColor::Green,
-                        FString::Printf(TEXT("Connected to IP : %s"), *IPAddress)
-                    );
-                }
-
+                GEngine->AddOnScreenDebugMessage
+                (
+                    -1,
+                    15.0f,
+                    FColor::Green,
+                    FString::Printf(TEXT("Connected to IP : %s"), *IPAddress)
+                );
             }
+
         }
     }
 
+    //Prefetched hosts may have filled up or left since, search again before giving up
+    if (Result != EOnJoinSessionCompleteResult::Success && bJoiningPrefetched && MultiplayerSessionsSubsystem)
+    {
+        bJoiningPrefetched = false;
+        SearchForSessions();
+        return;
+    }
+    bJoiningPrefetched = false;
+
     if (Result != EOnJoinSessionCompleteResult::Success)
     {
         Join->SetIsEnabled(true);
@@ -207,57 +254,42 @@ void UMenuSystem::OnDestroySession(bool bWasSuccessful)
 {
 }
 
-void UMenuSystem::OnFindSession(const TArray<FOnlineSessionSearchResult>& SessionResult, bool bWasSuccessful)
+void UMenuSystem::OnFindSessionSummary(const FMultiplayerSessionSummary& Summary, bool bIsFinal, bool bWasSuccessful)
 {
-
     if (GEngine)
     {
-        
-        GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Green, FString::Printf(TEXT("JoinButtonClicked4 %d"), SessionResult.Num()));
+        GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Green, FString::Printf(TEXT("Search Results %d sessions"), Summary.Num()));
     }
 
-    for (auto Result : SessionResult)
+    if (!bIsFinal)
     {
-        if (GEngine)
-        {
-            GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Green, FString("JoinButtonClicked4.1"));
-        }
-
-        FString Id = Result.GetSessionIdStr();
-        FString User = Result.Session.OwningUserName;
-        FString MatchMode;
-        Result.Session.SessionSettings.Get(FName("MatchType"), MatchMode);
-
-        if (MatchMode == FString("FreeForAll"))
-        {
-            if (GEngine)
-            {
-                GEngine->AddOnScreenDebugMessage
-                (
-                    -1,
-                    15.0f,
-                    FColor::Green,
-                    FString::Printf(TEXT("User:%s, Id:%s"), *Id, *User)
-                );
-            }
-
-            if (GEngine)
-            {
-                GEngine->AddOnScreenDebugMessage
-                (
-                    -1,
-                    15.0f,
-                    FColor::Green,
-                    FString::Printf(TEXT("Joined %s Match"), *MatchType)
-                );
-            }
-
-            MultiplayerSessionsSubsystem->JoinSessions(Result);
-        }
+        return;
     }
 
-    if (!bWasSuccessful || SessionResult.Num() == 0)
+    if (!bWasSuccessful || Summary.Num() == 0)
     {
         Join->SetIsEnabled(true);
+        return;
     }
-}
\ No newline at end of file
+
+    JoinBestMatch(Summary);
+}
+
+void UMenuSystem::JoinBestMatch(const FMultiplayerSessionSummary& Summary)
+{
+    if (GEngine)
+    {
+        GEngine->AddOnScreenDebugMessage
+        (
+            -1,
+            15.0f,
+            FColor::Green,
+            FString::Printf(TEXT("Joining best %s Match out of %d"), *MatchType, Summary.Num())
+        );
+    }
+
+    //Subsystem scores the summary and only resolves the sessions it actually tries to join
+    FMultiplayerSessionAttributes Desired;
+    Desired.MatchType = MatchType;
+    MultiplayerSessionsSubsystem->JoinBestSession(Summary, Desired);
+}
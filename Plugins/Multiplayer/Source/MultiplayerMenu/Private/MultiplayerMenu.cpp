@@ -0,0 +1,6 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Modules/ModuleManager.h"
+
+//Client only, servers are built without the menu and the UMG and Slate it needs
+IMPLEMENT_MODULE(FDefaultModuleImpl, MultiplayerMenu)
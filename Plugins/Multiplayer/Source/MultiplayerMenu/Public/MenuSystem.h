@@ -11,7 +11,7 @@
  * 
  */
 UCLASS()
-class MULTIPLAYER_API UMenuSystem : public UUserWidget
+class MULTIPLAYERMENU_API UMenuSystem : public UUserWidget
 {
 	GENERATED_BODY()
 	
@@ -31,6 +31,18 @@ private:
 	FString MatchType;
 	FString PathToLobby;
 
+	//Results asked for by the first page of a streamed search
+	int32 SearchPageSize = 50;
+
+	//Streamed search stops once this many sessions are there to pick the best from
+	int32 NumSessionsToRank = 8;
+
+	//Results kept warm by the background prefetch when the subsystem has it enabled
+	int32 PrefetchSearchResults = 200;
+
+	//Join was tried on prefetched results, a failure still gets a fresh search
+	bool bJoiningPrefetched = false;
+
 	UPROPERTY(meta = (BindWidget))
 		class UButton *Join;
 
@@ -52,7 +64,9 @@ private:
 	UFUNCTION()
 	void OnDestroySession(bool bWasSuccessful);
 
-	void OnFindSession(const TArray<FOnlineSessionSearchResult>& SessionResult, bool bWasSuccessful);
+	void OnFindSessionSummary(const struct FMultiplayerSessionSummary& Summary, bool bIsFinal, bool bWasSuccessful);
+	void JoinBestMatch(const FMultiplayerSessionSummary& Summary);
+	void SearchForSessions();
 	void OnJoinSession(EOnJoinSessionCompleteResult::Type Result);
 
 
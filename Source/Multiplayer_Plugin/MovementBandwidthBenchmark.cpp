@@ -0,0 +1,276 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "MultiplayerCharacterMovementComponent.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/NetSerialization.h"
+#include "UObject/CoreNet.h"
+#include "UObject/Package.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Parse.h"
+
+namespace
+{
+	struct FBenchmarkPlayer
+	{
+		UMultiplayerCharacterMovementComponent* ClientMovement = nullptr;
+		UMultiplayerCharacterMovementComponent* ServerMovement = nullptr;
+
+		FVector Location = FVector::ZeroVector;
+		FVector Acceleration = FVector::ZeroVector;
+		FVector Velocity = FVector::ZeroVector;
+		FRotator ControlRotation = FRotator::ZeroRotator;
+		bool bPressedJump = false;
+		float IdleUntil = 0.0f;
+
+		//Timestamps the client hears acknowledged one round trip after sending them
+		TArray<TPair<float, float>> PendingAcks;
+
+		//Proxy movement last sent in each format, unchanged movement isn't sent again
+		FRepMovement LastStockMovement;
+		FMultiplayerRepMovement LastCompactMovement;
+		bool bSentProxyMovement = false;
+	};
+
+	FRepMovement GetProxyMovement(const FBenchmarkPlayer& Player)
+	{
+		FRepMovement Movement;
+		Movement.Location = Player.Location;
+		Movement.Rotation = FRotator(0.0f, Player.ControlRotation.Yaw, 0.0f);
+		Movement.LinearVelocity = Player.Velocity;
+		return Movement;
+	}
+
+	void StepPlayer(FBenchmarkPlayer& Player, FRandomStream& Random, float Time, float DeltaTime)
+	{
+		//Players alternate between standing around and running with the view drifting
+		if (Time < Player.IdleUntil)
+		{
+			Player.Acceleration = FVector::ZeroVector;
+			Player.Velocity = FVector::ZeroVector;
+		}
+		else
+		{
+			if (Random.FRand() < 0.01f)
+			{
+				Player.IdleUntil = Time + Random.FRandRange(0.5f, 3.0f);
+			}
+
+			Player.ControlRotation.Yaw = FRotator::NormalizeAxis(Player.ControlRotation.Yaw + Random.FRandRange(-90.0f, 90.0f) * DeltaTime);
+			Player.ControlRotation.Pitch = FMath::Clamp(Player.ControlRotation.Pitch + Random.FRandRange(-20.0f, 20.0f) * DeltaTime, -60.0f, 60.0f);
+
+			const FVector Direction = FRotator(0.0f, Player.ControlRotation.Yaw, 0.0f).Vector();
+			Player.Acceleration = Direction * 2048.0f;
+			Player.Velocity = Direction * 600.0f;
+		}
+
+		Player.bPressedJump = Random.FRand() < 0.02f;
+		Player.Location += Player.Velocity * DeltaTime;
+	}
+
+	void FillSavedMove(FSavedMove_Character& Move, const FBenchmarkPlayer& Player, float TimeStamp)
+	{
+		Move.TimeStamp = TimeStamp;
+		Move.Acceleration = Player.Acceleration;
+		Move.StartLocation = Player.Location;
+		Move.SavedLocation = Player.Location;
+		Move.SavedControlRotation = Player.ControlRotation;
+		Move.bPressedJump = Player.bPressedJump;
+		Move.EndPackedMovementMode = MOVE_Walking;
+	}
+
+	//Sends the same simulated client moves through the stock and the quantized format and decodes the quantized ones on a server copy.
+	//The server's proxy updates of the same players go through the stock FRepMovement and the compact format
+	void RunMovementBandwidthBenchmark(const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		const FString Params = FString::Join(Args, TEXT(" "));
+		int32 NumPlayers = 100;
+		float Seconds = 10.0f;
+		int32 SendRate = 30;
+		float RttMs = 100.0f;
+		int32 ProxyRate = 30;
+		FParse::Value(*Params, TEXT("Players="), NumPlayers);
+		FParse::Value(*Params, TEXT("Seconds="), Seconds);
+		FParse::Value(*Params, TEXT("SendRate="), SendRate);
+		FParse::Value(*Params, TEXT("Rtt="), RttMs);
+		FParse::Value(*Params, TEXT("ProxyRate="), ProxyRate);
+		NumPlayers = FMath::Max(NumPlayers, 1);
+		SendRate = FMath::Max(SendRate, 1);
+
+		FRandomStream Random(1234);
+		TArray<FBenchmarkPlayer> Players;
+		Players.SetNum(NumPlayers);
+		for (FBenchmarkPlayer& Player : Players)
+		{
+			Player.ClientMovement = NewObject<UMultiplayerCharacterMovementComponent>(GetTransientPackage());
+			Player.ServerMovement = NewObject<UMultiplayerCharacterMovementComponent>(GetTransientPackage());
+			Player.Location = FVector(Random.FRandRange(-50000.0f, 50000.0f), Random.FRandRange(-50000.0f, 50000.0f), Random.FRandRange(0.0f, 2000.0f));
+			Player.ControlRotation.Yaw = Random.FRandRange(-180.0f, 180.0f);
+		}
+
+		FCharacterNetworkMoveDataContainer StockContainer;
+		FMultiplayerCharacterNetworkMoveDataContainer ClientContainer;
+		FMultiplayerCharacterNetworkMoveDataContainer ServerContainer;
+
+		const float DeltaTime = 1.0f / SendRate;
+		const float Rtt = RttMs / 1000.0f;
+		const int32 NumPackets = FMath::Max(FMath::RoundToInt(Seconds * SendRate), 1);
+
+		int64 StockBits = 0;
+		int64 QuantizedBits = 0;
+		int32 NumDecodeFailures = 0;
+		double MaxLocationError = 0.0;
+
+		int64 StockProxyBits = 0;
+		int64 CompactProxyBits = 0;
+		int32 NumStockProxyUpdates = 0;
+		int32 NumCompactProxyUpdates = 0;
+		double MaxProxyLocationError = 0.0;
+
+		for (int32 Packet = 0; Packet < NumPackets; ++Packet)
+		{
+			const float Time = (Packet + 1) * DeltaTime;
+			const bool bProxyFrame = FMath::FloorToInt(Time * ProxyRate) > FMath::FloorToInt((Time - DeltaTime) * ProxyRate);
+
+			for (FBenchmarkPlayer& Player : Players)
+			{
+				int32 NumArrived = 0;
+				while (NumArrived < Player.PendingAcks.Num() && Player.PendingAcks[NumArrived].Key <= Time)
+				{
+					++NumArrived;
+				}
+				if (NumArrived > 0)
+				{
+					Player.ClientMovement->GetMoveCodec().AcknowledgeMove(Player.PendingAcks[NumArrived - 1].Value);
+					Player.PendingAcks.RemoveAt(0, NumArrived, false);
+				}
+
+				//Moves that can't be combined ride along as pending, the occasional important move is resent as old
+				FSavedMove_Character PendingMove;
+				const bool bHasPending = Random.FRand() < 0.5f;
+				if (bHasPending)
+				{
+					StepPlayer(Player, Random, Time - DeltaTime * 0.5f, DeltaTime * 0.5f);
+					FillSavedMove(PendingMove, Player, Time - DeltaTime * 0.5f);
+				}
+
+				FSavedMove_Character OldMove;
+				const bool bHasOld = Random.FRand() < 0.1f;
+				if (bHasOld)
+				{
+					FillSavedMove(OldMove, Player, Time - DeltaTime * 2.0f);
+					OldMove.bPressedJump = true;
+				}
+
+				StepPlayer(Player, Random, Time, bHasPending ? DeltaTime * 0.5f : DeltaTime);
+				FSavedMove_Character NewMove;
+				FillSavedMove(NewMove, Player, Time);
+
+				const FSavedMove_Character* Pending = bHasPending ? &PendingMove : nullptr;
+				const FSavedMove_Character* Old = bHasOld ? &OldMove : nullptr;
+
+				FNetBitWriter StockWriter(nullptr, 1024);
+				StockContainer.ClientFillNetworkMoveData(&NewMove, Pending, Old);
+				StockContainer.Serialize(*Player.ClientMovement, StockWriter, nullptr);
+				StockBits += StockWriter.GetNumBits();
+
+				FNetBitWriter QuantizedWriter(nullptr, 1024);
+				ClientContainer.ClientFillNetworkMoveData(&NewMove, Pending, Old);
+				ClientContainer.Serialize(*Player.ClientMovement, QuantizedWriter, nullptr);
+				QuantizedBits += QuantizedWriter.GetNumBits();
+
+				FNetBitReader QuantizedReader(nullptr, QuantizedWriter.GetData(), QuantizedWriter.GetNumBits());
+				if (!ServerContainer.Serialize(*Player.ServerMovement, QuantizedReader, nullptr))
+				{
+					++NumDecodeFailures;
+					continue;
+				}
+
+				MaxLocationError = FMath::Max(MaxLocationError, FVector::Dist(ServerContainer.GetNewMoveData()->Location, NewMove.SavedLocation));
+				if (bHasPending)
+				{
+					MaxLocationError = FMath::Max(MaxLocationError, FVector::Dist(ServerContainer.GetPendingMoveData()->Location, PendingMove.SavedLocation));
+				}
+
+				Player.PendingAcks.Emplace(Time + Rtt, Time);
+			}
+
+			if (!bProxyFrame)
+			{
+				continue;
+			}
+
+			//Each format is only sent when it changed, the stock one on any change and the compact one on a change it can carry
+			for (FBenchmarkPlayer& Player : Players)
+			{
+				const FRepMovement StockMovement = GetProxyMovement(Player);
+				const FRepMovement& LastStock = Player.LastStockMovement;
+				if (!Player.bSentProxyMovement || StockMovement.Location != LastStock.Location
+					|| StockMovement.Rotation != LastStock.Rotation || StockMovement.LinearVelocity != LastStock.LinearVelocity)
+				{
+					FRepMovement SentMovement = StockMovement;
+					FNetBitWriter StockWriter(nullptr, 1024);
+					bool bSuccess = true;
+					SentMovement.NetSerialize(StockWriter, nullptr, bSuccess);
+					StockProxyBits += StockWriter.GetNumBits();
+					++NumStockProxyUpdates;
+					Player.LastStockMovement = StockMovement;
+				}
+
+				FMultiplayerRepMovement CompactMovement;
+				CompactMovement.FromRepMovement(StockMovement);
+				if (!Player.bSentProxyMovement || !(CompactMovement == Player.LastCompactMovement))
+				{
+					FNetBitWriter CompactWriter(nullptr, 1024);
+					bool bSuccess = true;
+					CompactMovement.NetSerialize(CompactWriter, nullptr, bSuccess);
+					CompactProxyBits += CompactWriter.GetNumBits();
+					++NumCompactProxyUpdates;
+					Player.LastCompactMovement = CompactMovement;
+
+					FNetBitReader CompactReader(nullptr, CompactWriter.GetData(), CompactWriter.GetNumBits());
+					FMultiplayerRepMovement Received;
+					FRepMovement ProxyMovement;
+					Received.NetSerialize(CompactReader, nullptr, bSuccess);
+					Received.ToRepMovement(ProxyMovement);
+					MaxProxyLocationError = FMath::Max(MaxProxyLocationError, FVector::Dist(ProxyMovement.Location, StockMovement.Location));
+				}
+
+				Player.bSentProxyMovement = true;
+			}
+		}
+
+		const double SimulatedSeconds = NumPackets * DeltaTime;
+		const double PlayerSeconds = double(NumPlayers) * SimulatedSeconds;
+		const double StockBytesPerSecond = StockBits / 8.0 / PlayerSeconds;
+		const double QuantizedBytesPerSecond = QuantizedBits / 8.0 / PlayerSeconds;
+
+		//Every connection is sent every other player's proxy
+		const double ProxyViewers = double(NumPlayers - 1) / NumPlayers;
+		const double StockProxyBytesPerSecond = StockProxyBits / 8.0 / SimulatedSeconds * ProxyViewers;
+		const double CompactProxyBytesPerSecond = CompactProxyBits / 8.0 / SimulatedSeconds * ProxyViewers;
+
+		Ar.Logf(TEXT("Client moves, %d players at %d packets/s for %.1fs with %.0fms round trips"), NumPlayers, SendRate, NumPackets * DeltaTime, RttMs);
+		Ar.Logf(TEXT("  Stock:     %.1f bytes/player/s"), StockBytesPerSecond);
+		Ar.Logf(TEXT("  Quantized: %.1f bytes/player/s, %.1f%% less"), QuantizedBytesPerSecond, StockBytesPerSecond > 0.0 ? 100.0 * (1.0 - QuantizedBytesPerSecond / StockBytesPerSecond) : 0.0);
+		Ar.Logf(TEXT("  Max location error %.3fcm, %d packets failed to decode"), MaxLocationError, NumDecodeFailures);
+		Ar.Logf(TEXT("Proxy movement sent by the server at %d updates/s, per player"), ProxyRate);
+		Ar.Logf(TEXT("  Stock:   %.1f bytes/player/s, %.1f bits per update, %d updates"),
+			StockProxyBytesPerSecond, NumStockProxyUpdates > 0 ? double(StockProxyBits) / NumStockProxyUpdates : 0.0, NumStockProxyUpdates);
+		Ar.Logf(TEXT("  Compact: %.1f bytes/player/s, %.1f bits per update, %d updates, %.1f%% less"),
+			CompactProxyBytesPerSecond, NumCompactProxyUpdates > 0 ? double(CompactProxyBits) / NumCompactProxyUpdates : 0.0, NumCompactProxyUpdates,
+			StockProxyBytesPerSecond > 0.0 ? 100.0 * (1.0 - CompactProxyBytesPerSecond / StockProxyBytesPerSecond) : 0.0);
+		Ar.Logf(TEXT("  Max proxy location error %.3fcm, server outgoing for all players %.1f KB/s stock, %.1f KB/s compact"),
+			MaxProxyLocationError, StockProxyBytesPerSecond * NumPlayers / 1024.0, CompactProxyBytesPerSecond * NumPlayers / 1024.0);
+		Ar.Logf(TEXT("Payload bits only, RPC, property and packet headers are the same for both formats"));
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice MovementBandwidthCommand(
+		TEXT("Multiplayer.Bench.MovementBandwidth"),
+		TEXT("Compares client move and proxy movement bandwidth of the stock and the compact formats. Players=100 Seconds=10 SendRate=30 Rtt=100 ProxyRate=30"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			RunMovementBandwidthBenchmark(Args, Ar);
+		}));
+}
@@ -0,0 +1,621 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerBotSubsystem.h"
+#include "Multiplayer_PluginCharacter.h"
+#include "MultiplayerGameMode.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "MultiplayerSessionSummary.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogMultiplayerBots, Log, All);
+
+namespace
+{
+	UMultiplayerBotSubsystem* GetBotSubsystem(UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		return GameInstance ? GameInstance->GetSubsystem<UMultiplayerBotSubsystem>() : nullptr;
+	}
+
+	EBotInputPattern ParsePattern(const FString& PatternName)
+	{
+		const int64 Value = StaticEnum<EBotInputPattern>()->GetValueByNameString(PatternName);
+		return Value != INDEX_NONE ? EBotInputPattern(Value) : EBotInputPattern::Mixed;
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice StartBotsCommand(
+		TEXT("Multiplayer.Bots.Start"),
+		TEXT("Joins a server and ramps up bots. Count= Ramp=<seconds between bots> Pattern=Idle|Wander|Circle|Strafe|Mixed Server=<address, searches when empty> Hold=<seconds>"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UMultiplayerBotSubsystem* Bots = GetBotSubsystem(World);
+			if (!Bots)
+			{
+				return;
+			}
+
+			const FString Params = FString::Join(Args, TEXT(" "));
+			int32 NumBots = 4;
+			float RampSeconds = 1.0f;
+			float HoldSeconds = 0.0f;
+			FString PatternName;
+			FString ServerAddress;
+			FParse::Value(*Params, TEXT("Count="), NumBots);
+			FParse::Value(*Params, TEXT("Ramp="), RampSeconds);
+			FParse::Value(*Params, TEXT("Hold="), HoldSeconds);
+			FParse::Value(*Params, TEXT("Pattern="), PatternName);
+			FParse::Value(*Params, TEXT("Server="), ServerAddress);
+
+			Bots->StartBots(NumBots, RampSeconds, ParsePattern(PatternName), ServerAddress, HoldSeconds);
+		}));
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice StopBotsCommand(
+		TEXT("Multiplayer.Bots.Stop"),
+		TEXT("Disconnects every bot of this process"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (UMultiplayerBotSubsystem* Bots = GetBotSubsystem(World))
+			{
+				Bots->StopBots();
+			}
+		}));
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice BotReportCommand(
+		TEXT("Multiplayer.Bots.Report"),
+		TEXT("Prints bot joins on a client and server load by player count on a server. \"Start\" and \"Stop\" turn the server's load samples on and off"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UMultiplayerBotSubsystem* Bots = GetBotSubsystem(World);
+			if (!Bots)
+			{
+				return;
+			}
+
+			if (Args.Num() > 0 && Args[0] == TEXT("Start"))
+			{
+				Bots->StartLoadReport();
+			}
+			else if (Args.Num() > 0 && Args[0] == TEXT("Stop"))
+			{
+				Bots->StopLoadReport();
+			}
+			Bots->DumpBotReport(Ar);
+		}));
+}
+
+void UMultiplayerBotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	if (FParse::Param(CommandLine, TEXT("BotReport")))
+	{
+		StartLoadReport();
+	}
+
+	int32 NumBots = 0;
+	if (IsRunningDedicatedServer() || !FParse::Value(CommandLine, TEXT("Bots="), NumBots) || NumBots <= 0)
+	{
+		return;
+	}
+
+	float RampSeconds = 1.0f;
+	float HoldSeconds = 0.0f;
+	FString PatternName;
+	FString ServerAddress;
+	FParse::Value(CommandLine, TEXT("BotRamp="), RampSeconds);
+	FParse::Value(CommandLine, TEXT("BotHold="), HoldSeconds);
+	FParse::Value(CommandLine, TEXT("BotPattern="), PatternName);
+	FParse::Value(CommandLine, TEXT("BotServer="), ServerAddress);
+
+	//A scripted run ends the process once its bots stop, done or failed, so a shell loop can start the next one
+	bExitWhenDone = HoldSeconds > 0.0f;
+	StartBots(NumBots, RampSeconds, ParsePattern(PatternName), ServerAddress, HoldSeconds);
+}
+
+void UMultiplayerBotSubsystem::Deinitialize()
+{
+	ResetBots();
+	StopLoadReport();
+	Super::Deinitialize();
+}
+
+UMultiplayerSessionsSubsystem* UMultiplayerBotSubsystem::GetSessionsSubsystem() const
+{
+	return GetGameInstance()->GetSubsystem<UMultiplayerSessionsSubsystem>();
+}
+
+void UMultiplayerBotSubsystem::StartBots(int32 NumBots, float RampSeconds, EBotInputPattern Pattern, const FString& ServerAddress, float HoldSeconds)
+{
+	if (IsRunningBots() || NumBots <= 0)
+	{
+		return;
+	}
+
+	if (MaxBotsPerProcess > 0 && NumBots > MaxBotsPerProcess)
+	{
+		UE_LOG(LogMultiplayerBots, Warning, TEXT("%d bots asked for, this process runs %d. Start more processes to reach more connections"), NumBots, MaxBotsPerProcess);
+		NumBots = MaxBotsPerProcess;
+	}
+
+	TargetBots = NumBots;
+	BotRampSeconds = FMath::Max(RampSeconds, 0.0f);
+	BotHoldSeconds = FMath::Max(HoldSeconds, 0.0f);
+	BotPattern = Pattern;
+	BotServerAddress = ServerAddress;
+	JoinStats = FBotJoinStats();
+
+	State = EBotState::Starting;
+	StateStartTime = FPlatformTime::Seconds();
+	NextProgressTime = StateStartTime + ReportIntervalSeconds;
+
+	if (UMultiplayerSessionsSubsystem* Sessions = GetSessionsSubsystem())
+	{
+		FindSessionSummaryHandle = Sessions->MultiplayerOnFindSessionSummaryDelegate.AddUObject(this, &ThisClass::OnFindSessionSummary);
+		JoinSessionHandle = Sessions->MultiplayerOnJoinSessionDelegate.AddUObject(this, &ThisClass::OnJoinSession);
+	}
+
+	BotTickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::TickBots));
+
+	UE_LOG(LogMultiplayerBots, Log, TEXT("Starting %d bots, one every %.1fs, %s"),
+		TargetBots, BotRampSeconds, ServerAddress.IsEmpty() ? TEXT("joining the best session found") : *ServerAddress);
+}
+
+void UMultiplayerBotSubsystem::StopBots()
+{
+	if (!IsRunningBots())
+	{
+		return;
+	}
+
+	LogBotProgress();
+
+	//The server only hears about the connection closing, the splitscreen players are cleaned up with it
+	UGameInstance* GameInstance = GetGameInstance();
+	for (const FBot& Bot : Bots)
+	{
+		ULocalPlayer* Player = Bot.Player.Get();
+		if (Player && Player != GameInstance->GetFirstGamePlayer())
+		{
+			GameInstance->RemoveLocalPlayer(Player);
+		}
+	}
+
+	UWorld* World = GameInstance->GetWorld();
+	if (GEngine && World && World->GetNetMode() == NM_Client)
+	{
+		GEngine->HandleDisconnect(World, World->GetNetDriver());
+	}
+
+	ResetBots();
+
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void UMultiplayerBotSubsystem::ResetBots()
+{
+	if (BotTickHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(BotTickHandle);
+		BotTickHandle.Reset();
+	}
+
+	if (UMultiplayerSessionsSubsystem* Sessions = GetSessionsSubsystem())
+	{
+		Sessions->MultiplayerOnFindSessionSummaryDelegate.Remove(FindSessionSummaryHandle);
+		Sessions->MultiplayerOnJoinSessionDelegate.Remove(JoinSessionHandle);
+	}
+	FindSessionSummaryHandle.Reset();
+	JoinSessionHandle.Reset();
+
+	Bots.Reset();
+	State = EBotState::Stopped;
+}
+
+bool UMultiplayerBotSubsystem::TickBots(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	UGameInstance* GameInstance = GetGameInstance();
+	UWorld* World = GameInstance->GetWorld();
+
+	switch (State)
+	{
+	case EBotState::Starting:
+		if (GameInstance->GetFirstLocalPlayerController())
+		{
+			State = EBotState::Joining;
+			StateStartTime = Now;
+			++JoinStats.SessionJoinAttempts;
+
+			UMultiplayerSessionsSubsystem* Sessions = GetSessionsSubsystem();
+			if (!BotServerAddress.IsEmpty())
+			{
+				TravelToServer(BotServerAddress);
+			}
+			else if (Sessions)
+			{
+				FMultiplayerSessionAttributes Filter;
+				Filter.MatchType = BotMatchType;
+				Sessions->FindSessions(MaxSearchResults, Filter);
+			}
+		}
+		break;
+
+	case EBotState::Joining:
+	case EBotState::Traveling:
+		if (State == EBotState::Traveling && World && World->GetNetMode() == NM_Client && GameInstance->GetFirstLocalPlayerController(World))
+		{
+			//This process's own player is the first bot, its join started with the travel
+			FBot& Bot = Bots.AddDefaulted_GetRef();
+			Bot.Player = GameInstance->GetFirstGamePlayer();
+			Bot.AddedTime = StateStartTime;
+			++JoinStats.Attempts;
+			++JoinStats.SessionJoins;
+
+			//Splitscreen players would otherwise each get a slice of the window, nobody looks at it
+			if (UGameViewportClient* Viewport = GameInstance->GetGameViewportClient())
+			{
+				Viewport->SetForceDisableSplitscreen(true);
+			}
+
+			State = EBotState::Ramping;
+			NextBotTime = Now + BotRampSeconds;
+		}
+		else if (Now - StateStartTime > SessionJoinTimeoutSeconds)
+		{
+			UE_LOG(LogMultiplayerBots, Warning, TEXT("No server joined after %.0fs, stopping"), SessionJoinTimeoutSeconds);
+			StopBots();
+			return false;
+		}
+		break;
+
+	case EBotState::Ramping:
+	case EBotState::Holding:
+		if (!World || World->GetNetMode() != NM_Client)
+		{
+			UE_LOG(LogMultiplayerBots, Warning, TEXT("Lost the connection to the server with %d bots joined, stopping"), JoinStats.Joined);
+			StopBots();
+			return false;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	if (State == EBotState::Ramping && Bots.Num() < TargetBots && Now >= NextBotTime)
+	{
+		NextBotTime = Now + BotRampSeconds;
+		if (!AddBot(Now))
+		{
+			//No local player slot left, every next one would fail the same way
+			TargetBots = Bots.Num();
+		}
+	}
+
+	bool bAllDecided = true;
+	for (FBot& Bot : Bots)
+	{
+		UpdateBotJoin(Bot, Now);
+		bAllDecided &= Bot.bJoined || Bot.bFailed;
+		if (Bot.bJoined)
+		{
+			DriveBot(Bot, Now);
+		}
+	}
+
+	if (State == EBotState::Ramping && Bots.Num() >= TargetBots && bAllDecided)
+	{
+		UE_LOG(LogMultiplayerBots, Log, TEXT("Ramp done"));
+		LogBotProgress();
+		State = EBotState::Holding;
+		StateStartTime = Now;
+	}
+
+	if (Now >= NextProgressTime)
+	{
+		NextProgressTime = Now + ReportIntervalSeconds;
+		LogBotProgress();
+	}
+
+	if (State == EBotState::Holding && BotHoldSeconds > 0.0f && Now - StateStartTime >= BotHoldSeconds)
+	{
+		StopBots();
+		return false;
+	}
+
+	return true;
+}
+
+void UMultiplayerBotSubsystem::OnFindSessionSummary(const FMultiplayerSessionSummary& Summary, bool bIsFinal, bool bWasSuccessful)
+{
+	if (State != EBotState::Joining || !bIsFinal)
+	{
+		return;
+	}
+
+	if (!bWasSuccessful || Summary.Num() == 0)
+	{
+		UE_LOG(LogMultiplayerBots, Warning, TEXT("No session found to join, stopping"));
+		StopBots();
+		return;
+	}
+
+	FMultiplayerSessionAttributes Desired;
+	Desired.MatchType = BotMatchType;
+	GetSessionsSubsystem()->JoinBestSession(Summary, Desired);
+}
+
+void UMultiplayerBotSubsystem::OnJoinSession(EOnJoinSessionCompleteResult::Type Result)
+{
+	if (State != EBotState::Joining)
+	{
+		return;
+	}
+
+	FString Address;
+	if (Result != EOnJoinSessionCompleteResult::Success || !GetSessionsSubsystem()->GetResolvedConnectString(Address))
+	{
+		UE_LOG(LogMultiplayerBots, Warning, TEXT("Joining the session failed, stopping"));
+		StopBots();
+		return;
+	}
+
+	TravelToServer(Address);
+}
+
+void UMultiplayerBotSubsystem::TravelToServer(const FString& Address)
+{
+	APlayerController* PlayerController = GetGameInstance()->GetFirstLocalPlayerController();
+	if (!PlayerController)
+	{
+		StopBots();
+		return;
+	}
+
+	State = EBotState::Traveling;
+	StateStartTime = FPlatformTime::Seconds();
+	PlayerController->ClientTravel(Address, ETravelType::TRAVEL_Absolute);
+}
+
+bool UMultiplayerBotSubsystem::AddBot(double Now)
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	int32 ControllerId = 1;
+	while (GameInstance->FindLocalPlayerFromControllerId(ControllerId))
+	{
+		++ControllerId;
+	}
+
+	//Spawning the controller on a client sends the split join, the server spawns it a controller and character
+	FString Error;
+	ULocalPlayer* Player = GameInstance->CreateLocalPlayer(ControllerId, Error, true);
+	++JoinStats.Attempts;
+
+	FBot& Bot = Bots.AddDefaulted_GetRef();
+	Bot.Player = Player;
+	Bot.AddedTime = Now;
+	if (!Player)
+	{
+		UE_LOG(LogMultiplayerBots, Warning, TEXT("Bot %d couldn't be added: %s"), Bots.Num(), *Error);
+		Bot.bFailed = true;
+		++JoinStats.Failed;
+		return false;
+	}
+
+	return true;
+}
+
+void UMultiplayerBotSubsystem::UpdateBotJoin(FBot& Bot, double Now)
+{
+	if (Bot.bJoined || Bot.bFailed)
+	{
+		return;
+	}
+
+	const ULocalPlayer* Player = Bot.Player.Get();
+	const APlayerController* PlayerController = Player ? Player->PlayerController : nullptr;
+	if (PlayerController && Cast<AMultiplayer_PluginCharacter>(PlayerController->GetPawn()))
+	{
+		const int32 Index = int32(&Bot - Bots.GetData());
+		Bot.bJoined = true;
+		Bot.Random.Initialize(Index * 7919 + 1);
+		Bot.Pattern = BotPattern == EBotInputPattern::Mixed ? EBotInputPattern(int32(EBotInputPattern::Wander) + Index % 3) : BotPattern;
+
+		const double JoinSeconds = Now - Bot.AddedTime;
+		++JoinStats.Joined;
+		JoinStats.LastJoinSeconds = JoinSeconds;
+		JoinStats.TotalJoinSeconds += JoinSeconds;
+		JoinStats.MaxJoinSeconds = FMath::Max(JoinStats.MaxJoinSeconds, JoinSeconds);
+	}
+	else if (Now - Bot.AddedTime > BotJoinTimeoutSeconds)
+	{
+		Bot.bFailed = true;
+		++JoinStats.Failed;
+		UE_LOG(LogMultiplayerBots, Warning, TEXT("A bot had no character after %.0fs"), BotJoinTimeoutSeconds);
+	}
+}
+
+void UMultiplayerBotSubsystem::DriveBot(FBot& Bot, double Now)
+{
+	const ULocalPlayer* Player = Bot.Player.Get();
+	AMultiplayer_PluginCharacter* Character = Player && Player->PlayerController ? Cast<AMultiplayer_PluginCharacter>(Player->PlayerController->GetPawn()) : nullptr;
+	if (!Character)
+	{
+		return;
+	}
+
+	FRandomStream& Random = Bot.Random;
+	if (Now >= Bot.ChangeInputTime)
+	{
+		switch (Bot.Pattern)
+		{
+		case EBotInputPattern::Wander:
+			{
+				const bool bStop = Random.FRand() < 0.2f;
+				Bot.Forward = bStop ? 0.0f : 1.0f;
+				Bot.TurnRate = bStop ? 0.0f : Random.FRandRange(-0.5f, 0.5f);
+				Bot.ChangeInputTime = Now + Random.FRandRange(1.0f, 3.0f);
+			}
+			break;
+
+		case EBotInputPattern::Circle:
+			Bot.Forward = 1.0f;
+			Bot.TurnRate = 0.4f;
+			Bot.ChangeInputTime = MAX_dbl;
+			break;
+
+		case EBotInputPattern::Strafe:
+			Bot.Right = Bot.Right > 0.0f ? -1.0f : 1.0f;
+			Bot.ChangeInputTime = Now + 1.5;
+			break;
+
+		default:
+			Bot.ChangeInputTime = MAX_dbl;
+			break;
+		}
+	}
+
+	const bool bJump = Bot.Pattern == EBotInputPattern::Wander && Bot.Forward > 0.0f && Random.FRand() < 0.02f;
+	Character->ApplyBotInput(Bot.Forward, Bot.Right, Bot.TurnRate, bJump);
+}
+
+void UMultiplayerBotSubsystem::LogBotProgress() const
+{
+	DumpBotReport(*GLog);
+}
+
+void UMultiplayerBotSubsystem::StartLoadReport()
+{
+	if (LoadReportTickHandle.IsValid())
+	{
+		return;
+	}
+
+	LoadSamples.Reset();
+	SampleStartTime = FPlatformTime::Seconds();
+	SampleBusySeconds = 0.0;
+	SampleFrameSeconds = 0.0;
+	SampleMaxBusySeconds = 0.0;
+	SampleFrames = 0;
+	LoadReportTickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::TickLoadReport));
+}
+
+void UMultiplayerBotSubsystem::StopLoadReport()
+{
+	if (LoadReportTickHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(LoadReportTickHandle);
+		LoadReportTickHandle.Reset();
+	}
+}
+
+bool UMultiplayerBotSubsystem::TickLoadReport(float DeltaTime)
+{
+	//Undilated frame time, the idle part is what the server slept to hold its tick rate
+	const double FrameTime = FApp::GetDeltaTime();
+	const double BusyTime = FMath::Max(FrameTime - FApp::GetIdleTime(), 0.0);
+	SampleFrameSeconds += FrameTime;
+	SampleBusySeconds += BusyTime;
+	SampleMaxBusySeconds = FMath::Max(SampleMaxBusySeconds, BusyTime);
+	++SampleFrames;
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now - SampleStartTime >= ReportIntervalSeconds)
+	{
+		AddLoadSample(Now);
+	}
+	return true;
+}
+
+void UMultiplayerBotSubsystem::AddLoadSample(double Now)
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+	UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+
+	FBotLoadSample& Sample = LoadSamples.AddDefaulted_GetRef();
+	Sample.Time = Now;
+	Sample.Players = World && World->GetGameState() ? World->GetGameState()->PlayerArray.Num() : 0;
+	Sample.AverageBusyMs = SampleFrames > 0 ? SampleBusySeconds * 1000.0 / SampleFrames : 0.0;
+	Sample.MaxBusyMs = SampleMaxBusySeconds * 1000.0;
+	Sample.AverageFrameMs = SampleFrames > 0 ? SampleFrameSeconds * 1000.0 / SampleFrames : 0.0;
+
+	if (NetDriver)
+	{
+		Sample.Connections = NetDriver->ClientConnections.Num();
+		for (const UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			Sample.InBytesPerSecond += Connection->InBytesPerSecond;
+			Sample.OutBytesPerSecond += Connection->OutBytesPerSecond;
+		}
+	}
+
+	if (const AMultiplayerGameMode* GameMode = World ? World->GetAuthGameMode<AMultiplayerGameMode>() : nullptr)
+	{
+		Sample.Admitted = GameMode->GetAdmissionStats().Admitted;
+		Sample.Rejected = GameMode->GetAdmissionStats().Rejected;
+	}
+
+	UE_LOG(LogMultiplayerBots, Log, TEXT("Load: %d players on %d connections, tick %.2fms mean %.2fms max, frame %.2fms, in %.1f KB/s, out %.1f KB/s, admitted %d, rejected %d"),
+		Sample.Players, Sample.Connections, Sample.AverageBusyMs, Sample.MaxBusyMs, Sample.AverageFrameMs,
+		Sample.InBytesPerSecond / 1024.0, Sample.OutBytesPerSecond / 1024.0, Sample.Admitted, Sample.Rejected);
+
+	SampleStartTime = Now;
+	SampleBusySeconds = 0.0;
+	SampleFrameSeconds = 0.0;
+	SampleMaxBusySeconds = 0.0;
+	SampleFrames = 0;
+}
+
+void UMultiplayerBotSubsystem::DumpBotReport(FOutputDevice& Ar) const
+{
+	if (IsRunningBots() || JoinStats.Attempts > 0)
+	{
+		int32 NumJoined = 0;
+		for (const FBot& Bot : Bots)
+		{
+			NumJoined += Bot.bJoined ? 1 : 0;
+		}
+
+		Ar.Logf(TEXT("Bots: %d of %d running, connected %d of %d times"),
+			NumJoined, TargetBots, JoinStats.SessionJoins, JoinStats.SessionJoinAttempts);
+		Ar.Logf(TEXT("  joins %d of %d, %d failed, %.0f%% success, join %.2fs last, %.2fs mean, %.2fs max"),
+			JoinStats.Joined, JoinStats.Attempts, JoinStats.Failed, JoinStats.GetJoinSuccessRate() * 100.0,
+			JoinStats.LastJoinSeconds, JoinStats.GetAverageJoinSeconds(), JoinStats.MaxJoinSeconds);
+
+		const UWorld* World = GetGameInstance()->GetWorld();
+		const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+		if (const UNetConnection* Connection = NetDriver ? NetDriver->ServerConnection : nullptr)
+		{
+			Ar.Logf(TEXT("  connection in %.1f KB/s, out %.1f KB/s, %.0fms ping"),
+				Connection->InBytesPerSecond / 1024.0, Connection->OutBytesPerSecond / 1024.0, Connection->AvgLag * 1000.0);
+		}
+	}
+
+	if (LoadSamples.Num() > 0)
+	{
+		Ar.Logf(TEXT("Server load, one row every %.0fs:"), ReportIntervalSeconds);
+		for (const FBotLoadSample& Sample : LoadSamples)
+		{
+			Ar.Logf(TEXT("  %3d players on %3d connections: tick %.2fms mean %.2fms max, frame %.2fms, in %.1f KB/s, out %.1f KB/s, admitted %d, rejected %d"),
+				Sample.Players, Sample.Connections, Sample.AverageBusyMs, Sample.MaxBusyMs, Sample.AverageFrameMs,
+				Sample.InBytesPerSecond / 1024.0, Sample.OutBytesPerSecond / 1024.0, Sample.Admitted, Sample.Rejected);
+		}
+	}
+}
@@ -0,0 +1,236 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/Ticker.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "MultiplayerBotSubsystem.generated.h"
+
+class ULocalPlayer;
+class UMultiplayerSessionsSubsystem;
+struct FMultiplayerSessionSummary;
+
+/**
+ * Scripted input a bot plays back once it has a character
+ */
+UENUM()
+enum class EBotInputPattern : uint8
+{
+	//Stands still, a player sitting in the lobby
+	Idle,
+
+	//Runs with the view drifting, stops now and then and jumps a little
+	Wander,
+
+	//Runs in a circle at a steady turn rate
+	Circle,
+
+	//Strafes left and right in place
+	Strafe,
+
+	//Every bot takes the pattern after the previous bot's, Idle excluded
+	Mixed
+};
+
+/**
+ * Joins of one bot process, the session join of its connection and the splitscreen joins riding on it
+ */
+struct FBotJoinStats
+{
+	//Searches or direct travels, and the ones that ended connected to the server
+	int32 SessionJoinAttempts = 0;
+	int32 SessionJoins = 0;
+
+	int32 Attempts = 0;
+	int32 Joined = 0;
+
+	//Bots that had no character after BotJoinTimeoutSeconds
+	int32 Failed = 0;
+
+	//Seconds from adding the bot to it controlling a character
+	double LastJoinSeconds = 0.0;
+	double TotalJoinSeconds = 0.0;
+	double MaxJoinSeconds = 0.0;
+
+	double GetAverageJoinSeconds() const
+	{
+		return Joined > 0 ? TotalJoinSeconds / Joined : 0.0;
+	}
+
+	//Decided joins only, bots still waiting count for neither side
+	double GetJoinSuccessRate() const
+	{
+		return Joined + Failed > 0 ? double(Joined) / (Joined + Failed) : 0.0;
+	}
+};
+
+/**
+ * Server load over one report interval, logged while bots ramp up so every row is one step of the ramp
+ */
+struct FBotLoadSample
+{
+	double Time = 0.0;
+	int32 Players = 0;
+
+	//Client connections, splitscreen bots share their process's one. Relevancy and replication run per connection, so this is the server's real load
+	int32 Connections = 0;
+
+	//Frame time the server spent working, without what it slept to hold its tick rate
+	double AverageBusyMs = 0.0;
+	double MaxBusyMs = 0.0;
+	double AverageFrameMs = 0.0;
+
+	//Summed over every client connection
+	double InBytesPerSecond = 0.0;
+	double OutBytesPerSecond = 0.0;
+
+	//Admission counters of the game mode, INDEX_NONE when it doesn't queue logins
+	int32 Admitted = INDEX_NONE;
+	int32 Rejected = INDEX_NONE;
+};
+
+/**
+ * Headless load generator. On a client it finds and joins a session through the sessions subsystem, then adds bots
+ * one after another as splitscreen players on that connection and drives their characters through the same input
+ * paths as a player. On a server it logs tick time, bandwidth and joins as the player count grows.
+ *
+ * Started with -Bots=N on the command line or "Multiplayer.Bots.Start", see the README for running it over loopback.
+ */
+UCLASS(Config = Game)
+class MULTIPLAYER_PLUGIN_API UMultiplayerBotSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Joins a server and ramps up to NumBots bots, the first one is this process's own player.
+	 * @param RampSeconds		Seconds between two bots joining
+	 * @param ServerAddress		Address to travel to directly, empty searches for a session and joins the best one
+	 * @param HoldSeconds		Seconds to keep every bot running once the ramp is done, 0 runs until stopped
+	 */
+	void StartBots(int32 NumBots, float RampSeconds, EBotInputPattern Pattern, const FString& ServerAddress = FString(), float HoldSeconds = 0.0f);
+
+	//Disconnects every bot, the splitscreen players go with the connection
+	void StopBots();
+	bool IsRunningBots() const { return State != EBotState::Stopped; }
+
+	//Logs a load sample every ReportIntervalSeconds, on the server the bots connect to
+	void StartLoadReport();
+	void StopLoadReport();
+
+	const FBotJoinStats& GetJoinStats() const { return JoinStats; }
+	const TArray<FBotLoadSample>& GetLoadSamples() const { return LoadSamples; }
+
+	//Bot joins and connection bandwidth on a client, the load samples so far on a server. Also printed by "Multiplayer.Bots.Report"
+	void DumpBotReport(FOutputDevice& Ar) const;
+
+protected:
+
+	//Seconds between lines of the bot and load reports
+	UPROPERTY(Config)
+	float ReportIntervalSeconds = 5.0f;
+
+	//A bot without a character after this long counts as a failed join
+	UPROPERTY(Config)
+	float BotJoinTimeoutSeconds = 30.0f;
+
+	//Gives up on finding and joining a session after this long
+	UPROPERTY(Config)
+	float SessionJoinTimeoutSeconds = 60.0f;
+
+	//Sessions asked for by the search, the best one is joined
+	UPROPERTY(Config)
+	int32 MaxSearchResults = 100;
+
+	//Match type the bots search for, empty joins any
+	UPROPERTY(Config)
+	FString BotMatchType = TEXT("FreeForAll");
+
+	//Bots one process runs at most, 0 for no cap. They all share one connection, so ramps meant to load the server spread over processes
+	UPROPERTY(Config)
+	int32 MaxBotsPerProcess = 4;
+
+private:
+
+	enum class EBotState : uint8
+	{
+		Stopped,
+
+		//Waiting for the local player to exist before searching
+		Starting,
+		Joining,
+		Traveling,
+		Ramping,
+		Holding
+	};
+
+	struct FBot
+	{
+		TWeakObjectPtr<ULocalPlayer> Player;
+		EBotInputPattern Pattern = EBotInputPattern::Wander;
+		FRandomStream Random;
+		double AddedTime = 0.0;
+		bool bJoined = false;
+		bool bFailed = false;
+
+		//Input held until ChangeInputTime, patterns pick new values then
+		float Forward = 0.0f;
+		float Right = 0.0f;
+		float TurnRate = 0.0f;
+		double ChangeInputTime = 0.0;
+	};
+
+	bool TickBots(float DeltaTime);
+	bool TickLoadReport(float DeltaTime);
+
+	void OnFindSessionSummary(const FMultiplayerSessionSummary& Summary, bool bIsFinal, bool bWasSuccessful);
+	void OnJoinSession(EOnJoinSessionCompleteResult::Type Result);
+	void TravelToServer(const FString& Address);
+
+	//The first bot is the local player that traveled, every next one joins the connection as a splitscreen player
+	bool AddBot(double Now);
+	void UpdateBotJoin(FBot& Bot, double Now);
+	void DriveBot(FBot& Bot, double Now);
+
+	//Drops the bots and every binding without touching the connection, StopBots also disconnects
+	void ResetBots();
+
+	void AddLoadSample(double Now);
+	void LogBotProgress() const;
+
+	UMultiplayerSessionsSubsystem* GetSessionsSubsystem() const;
+
+	EBotState State = EBotState::Stopped;
+	int32 TargetBots = 0;
+	float BotRampSeconds = 1.0f;
+	float BotHoldSeconds = 0.0f;
+	EBotInputPattern BotPattern = EBotInputPattern::Mixed;
+	FString BotServerAddress;
+
+	//Started from the command line with a hold, the process exits once the bots stop
+	bool bExitWhenDone = false;
+
+	TArray<FBot> Bots;
+	double StateStartTime = 0.0;
+	double NextBotTime = 0.0;
+	double NextProgressTime = 0.0;
+	FBotJoinStats JoinStats;
+	FTSTicker::FDelegateHandle BotTickHandle;
+	FDelegateHandle FindSessionSummaryHandle;
+	FDelegateHandle JoinSessionHandle;
+
+	//Load Report, frame times summed since the last sample
+	FTSTicker::FDelegateHandle LoadReportTickHandle;
+	TArray<FBotLoadSample> LoadSamples;
+	double SampleStartTime = 0.0;
+	double SampleBusySeconds = 0.0;
+	double SampleFrameSeconds = 0.0;
+	double SampleMaxBusySeconds = 0.0;
+	int32 SampleFrames = 0;
+};
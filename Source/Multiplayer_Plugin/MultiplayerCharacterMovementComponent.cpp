@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerCharacterMovementComponent.h"
+#include "Engine/NetSerialization.h"
+
+namespace
+{
+	//Enough for any location inside the world bounds at a tenth of a centimetre
+	constexpr int32 MaxLocationBits = 30;
+
+	template<typename ValueType>
+	void SerializeOptional(FArchive& Ar, ValueType& Value, const ValueType& DefaultValue)
+	{
+		bool bIsDefault = Ar.IsSaving() && Value == DefaultValue;
+		Ar.SerializeBits(&bIsDefault, 1);
+		if (!bIsDefault)
+		{
+			Ar << Value;
+		}
+		else if (Ar.IsLoading())
+		{
+			Value = DefaultValue;
+		}
+	}
+
+	//Pending and old moves mostly repeat the new move's input
+	template<typename ValueType, typename ReferenceType, typename SerializeFunc>
+	void SerializeUnlessSame(FArchive& Ar, ValueType& Value, const ReferenceType& Reference, SerializeFunc&& SerializeValue)
+	{
+		bool bIsSame = Ar.IsSaving() && Value == Reference;
+		Ar.SerializeBits(&bIsSame, 1);
+		if (!bIsSame)
+		{
+			SerializeValue();
+		}
+		else if (Ar.IsLoading())
+		{
+			Value = Reference;
+		}
+	}
+}
+
+
+//Codec
+
+FVector FQuantizedMoveCodec::QuantizeLocation(const FVector& Location)
+{
+	return FVector(
+		FMath::RoundToDouble(Location.X * LocationScale) / LocationScale,
+		FMath::RoundToDouble(Location.Y * LocationScale) / LocationScale,
+		FMath::RoundToDouble(Location.Z * LocationScale) / LocationScale);
+}
+
+void FQuantizedMoveCodec::AcknowledgeMove(float TimeStamp)
+{
+	if (bHasAckedBase && TimeStamp == AckedTimeStamp)
+	{
+		return;
+	}
+
+	//Acks are for recent moves, so the walk back from the newest is short
+	for (uint32 Age = 1; Age < MaxBaseAge; ++Age)
+	{
+		const uint8 Sequence = static_cast<uint8>(NextSequence - Age);
+		if (!bKnownLocations[Sequence])
+		{
+			return;
+		}
+
+		if (TimeStamps[Sequence] == TimeStamp)
+		{
+			AckedSequence = Sequence;
+			AckedTimeStamp = TimeStamp;
+			bHasAckedBase = true;
+			return;
+		}
+	}
+}
+
+bool FQuantizedMoveCodec::SerializeNewMoveLocation(FArchive& Ar, float TimeStamp, FVector& Location)
+{
+	uint8 Sequence = NextSequence;
+	uint32 BaseAge = static_cast<uint8>(Sequence - AckedSequence);
+	bool bHasBase = Ar.IsSaving() && bHasAckedBase && BaseAge > 0 && BaseAge < MaxBaseAge;
+
+	Ar << Sequence;
+	Ar.SerializeBits(&bHasBase, 1);
+	if (bHasBase)
+	{
+		Ar.SerializeInt(BaseAge, MaxBaseAge);
+	}
+
+	//Acknowledged means received, a base the server doesn't know is a corrupt packet
+	const uint8 BaseSequence = static_cast<uint8>(Sequence - BaseAge);
+	if (bHasBase && !bKnownLocations[BaseSequence])
+	{
+		Ar.SetError();
+		return false;
+	}
+
+	const FVector Base = bHasBase ? Locations[BaseSequence] : FVector::ZeroVector;
+	FVector Delta = Ar.IsSaving() ? QuantizeLocation(Location) - Base : FVector::ZeroVector;
+	SerializePackedVector<LocationScale, MaxLocationBits>(Delta, Ar);
+
+	//Both ends requantize, so the next delta starts from the exact same value
+	Location = QuantizeLocation(Base + Delta);
+	Locations[Sequence] = Location;
+	TimeStamps[Sequence] = TimeStamp;
+	bKnownLocations[Sequence] = true;
+	PacketLocation = Location;
+	NextSequence = static_cast<uint8>(Sequence + 1);
+	return !Ar.IsError();
+}
+
+void FQuantizedMoveCodec::SerializePendingMoveLocation(FArchive& Ar, FVector& Location) const
+{
+	FVector Delta = Ar.IsSaving() ? QuantizeLocation(Location) - PacketLocation : FVector::ZeroVector;
+	SerializePackedVector<LocationScale, MaxLocationBits>(Delta, Ar);
+	Location = QuantizeLocation(PacketLocation + Delta);
+}
+
+
+//Move Data
+
+void FMultiplayerCharacterNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	FCharacterNetworkMoveData::ClientFillNetworkMoveData(ClientMove, MoveType);
+	Location = FQuantizedMoveCodec::QuantizeLocation(Location);
+}
+
+bool FMultiplayerCharacterNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	//Only ever installed by the multiplayer movement component
+	FQuantizedMoveCodec& Codec = static_cast<UMultiplayerCharacterMovementComponent&>(CharacterMovement).GetMoveCodec();
+
+	NetworkMoveType = MoveType;
+	bool bLocalSuccess = true;
+
+	Ar << TimeStamp;
+
+	if (MoveType == ENetworkMoveType::NewMove)
+	{
+		//Standing players send no acceleration at all
+		SerializeUnlessSame(Ar, Acceleration, FVector::ZeroVector, [&]() { Acceleration.NetSerialize(Ar, PackageMap, bLocalSuccess); });
+		Codec.SerializeNewMoveLocation(Ar, TimeStamp, Location);
+		ControlRotation.NetSerialize(Ar, PackageMap, bLocalSuccess);
+
+		Codec.PacketAcceleration = Acceleration;
+		Codec.PacketControlRotation = ControlRotation;
+	}
+	else
+	{
+		SerializeUnlessSame(Ar, Acceleration, Codec.PacketAcceleration, [&]() { Acceleration.NetSerialize(Ar, PackageMap, bLocalSuccess); });
+
+		//Old moves are only replayed for their input, the server never looks at where they ended up
+		if (MoveType == ENetworkMoveType::PendingMove)
+		{
+			Codec.SerializePendingMoveLocation(Ar, Location);
+			SerializeUnlessSame(Ar, ControlRotation, Codec.PacketControlRotation, [&]() { ControlRotation.NetSerialize(Ar, PackageMap, bLocalSuccess); });
+		}
+	}
+
+	SerializeOptional<uint8>(Ar, CompressedMoveFlags, 0);
+
+	//Base and movement mode are only used to check the final position
+	if (MoveType == ENetworkMoveType::NewMove)
+	{
+		SerializeOptional<UPrimitiveComponent*>(Ar, MovementBase, nullptr);
+		SerializeOptional<FName>(Ar, MovementBaseBoneName, NAME_None);
+		SerializeOptional<uint8>(Ar, MovementMode, MOVE_Walking);
+	}
+
+	return bLocalSuccess && !Ar.IsError();
+}
+
+FMultiplayerCharacterNetworkMoveDataContainer::FMultiplayerCharacterNetworkMoveDataContainer()
+{
+	NewMoveData = &MoveData[0];
+	PendingMoveData = &MoveData[1];
+	OldMoveData = &MoveData[2];
+}
+
+
+//Proxy Movement
+
+void FMultiplayerRepMovement::FromRepMovement(const FRepMovement& Movement)
+{
+	Location = FVector(FMath::RoundToDouble(Movement.Location.X), FMath::RoundToDouble(Movement.Location.Y), FMath::RoundToDouble(Movement.Location.Z));
+	Velocity = FVector(
+		FMath::RoundToDouble(Movement.LinearVelocity.X / VelocityStep) * VelocityStep,
+		FMath::RoundToDouble(Movement.LinearVelocity.Y / VelocityStep) * VelocityStep,
+		FMath::RoundToDouble(Movement.LinearVelocity.Z / VelocityStep) * VelocityStep);
+	Yaw = FRotator::CompressAxisToByte(Movement.Rotation.Yaw);
+	Pitch = FRotator::CompressAxisToByte(Movement.Rotation.Pitch);
+	Roll = FRotator::CompressAxisToByte(Movement.Rotation.Roll);
+}
+
+void FMultiplayerRepMovement::ToRepMovement(FRepMovement& Movement) const
+{
+	Movement.Location = Location;
+	Movement.Rotation = FRotator(FRotator::DecompressAxisFromByte(Pitch), FRotator::DecompressAxisFromByte(Yaw), FRotator::DecompressAxisFromByte(Roll));
+	Movement.LinearVelocity = Velocity;
+	Movement.AngularVelocity = FVector::ZeroVector;
+	Movement.bSimulatedPhysicSleep = false;
+	Movement.bRepPhysics = false;
+}
+
+bool FMultiplayerRepMovement::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = SerializePackedVector<1, 24>(Location, Ar);
+	Ar << Yaw;
+
+	bool bHasPitchRoll = Ar.IsSaving() && (Pitch != 0 || Roll != 0);
+	Ar.SerializeBits(&bHasPitchRoll, 1);
+	if (bHasPitchRoll)
+	{
+		Ar << Pitch;
+		Ar << Roll;
+	}
+	else if (Ar.IsLoading())
+	{
+		Pitch = 0;
+		Roll = 0;
+	}
+
+	bool bMoving = Ar.IsSaving() && !Velocity.IsZero();
+	Ar.SerializeBits(&bMoving, 1);
+	if (bMoving)
+	{
+		FVector Steps = Velocity / VelocityStep;
+		bOutSuccess &= SerializePackedVector<1, 20>(Steps, Ar);
+		if (Ar.IsLoading())
+		{
+			Velocity = Steps * VelocityStep;
+		}
+	}
+	else if (Ar.IsLoading())
+	{
+		Velocity = FVector::ZeroVector;
+	}
+
+	return true;
+}
+
+
+//Component
+
+UMultiplayerCharacterMovementComponent::UMultiplayerCharacterMovementComponent(const FObjectInitializer& ObjectInitializer) :
+	Super(ObjectInitializer)
+{
+	SetNetworkMoveDataContainer(MultiplayerMoveDataContainer);
+}
+
+void UMultiplayerCharacterMovementComponent::ResetPredictionData_Client()
+{
+	Super::ResetPredictionData_Client();
+	MoveCodec = FQuantizedMoveCodec();
+}
+
+void UMultiplayerCharacterMovementComponent::CallServerMovePacked(const FSavedMove_Character* NewMove, const FSavedMove_Character* PendingMove, const FSavedMove_Character* OldMove)
+{
+	//The newest acknowledgement becomes the base of this packet's new move
+	const FNetworkPredictionData_Client_Character* ClientData = GetPredictionData_Client_Character();
+	if (ClientData && ClientData->LastAckedMove.IsValid())
+	{
+		MoveCodec.AcknowledgeMove(ClientData->LastAckedMove->TimeStamp);
+	}
+
+	Super::CallServerMovePacked(NewMove, PendingMove, OldMove);
+}
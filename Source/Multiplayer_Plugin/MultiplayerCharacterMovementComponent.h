@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/CharacterMovementReplication.h"
+#include "Containers/StaticArray.h"
+#include "MultiplayerCharacterMovementComponent.generated.h"
+
+/**
+ * Quantizes the locations of client moves and sends them relative to the last move the server acknowledged.
+ * Both ends remember the location of every move by sequence number, so the base a delta refers to is never ambiguous.
+ */
+class MULTIPLAYER_PLUGIN_API FQuantizedMoveCodec
+{
+public:
+
+	//Locations go out in tenths of a centimetre, well inside the server's position error tolerance
+	static constexpr int32 LocationScale = 10;
+
+	static FVector QuantizeLocation(const FVector& Location);
+
+	//Client, later moves go relative to the acknowledged one for as long as it is recent enough
+	void AcknowledgeMove(float TimeStamp);
+
+	//New moves carry their sequence number and a delta to the acknowledged move, or their full location without one
+	bool SerializeNewMoveLocation(FArchive& Ar, float TimeStamp, FVector& Location);
+
+	//Pending moves go relative to the new move of the same packet, which is always serialized first
+	void SerializePendingMoveLocation(FArchive& Ar, FVector& Location) const;
+
+	//Input of the new move in the packet being serialized, pending and old moves repeating it send one bit instead
+	FVector PacketAcceleration = FVector::ZeroVector;
+	FRotator PacketControlRotation = FRotator::ZeroRotator;
+
+private:
+
+	//Sequence numbers wrap, bases older than this aren't used so neither end can have overwritten them yet
+	static constexpr uint32 MaxBaseAge = 128;
+
+	//Location of every move by sequence number, sent ones on the client and received ones on the server
+	TStaticArray<FVector, 256> Locations;
+	TStaticArray<float, 256> TimeStamps;
+	TStaticArray<bool, 256> bKnownLocations = TStaticArray<bool, 256>(InPlace, false);
+
+	uint8 NextSequence = 0;
+	uint8 AckedSequence = 0;
+	bool bHasAckedBase = false;
+	float AckedTimeStamp = -1.0f;
+	FVector PacketLocation = FVector::ZeroVector;
+};
+
+/**
+ * Client move with quantized locations, input shared with the new move costs one bit in the pending and old moves
+ */
+struct MULTIPLAYER_PLUGIN_API FMultiplayerCharacterNetworkMoveData : public FCharacterNetworkMoveData
+{
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+};
+
+struct MULTIPLAYER_PLUGIN_API FMultiplayerCharacterNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+	FMultiplayerCharacterNetworkMoveDataContainer();
+
+	FMultiplayerCharacterNetworkMoveData MoveData[3];
+};
+
+/**
+ * Movement the server sends to simulated proxies of a character, in place of the actor's FRepMovement.
+ * Characters turn around their yaw only and stand still most of the time, so pitch and roll cost a bit unless set and a
+ * standing character's velocity costs one. Compared after quantization, changes too small to arrive aren't sent at all.
+ */
+USTRUCT()
+struct MULTIPLAYER_PLUGIN_API FMultiplayerRepMovement
+{
+	GENERATED_BODY()
+
+	//Velocity goes out in steps of this many cm/s, plenty for extrapolating between updates and for animation
+	static constexpr int32 VelocityStep = 4;
+
+	//Server, quantizes the movement the actor gathered for replication
+	void FromRepMovement(const FRepMovement& Movement);
+
+	//Proxy, the engine's smoothing takes it from the actor's own replicated movement
+	void ToRepMovement(FRepMovement& Movement) const;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FMultiplayerRepMovement& Other) const
+	{
+		return Location == Other.Location && Velocity == Other.Velocity && Yaw == Other.Yaw && Pitch == Other.Pitch && Roll == Other.Roll;
+	}
+
+	//Whole centimetres, as the stock format sends them
+	FVector Location = FVector::ZeroVector;
+
+	//Multiples of VelocityStep
+	FVector Velocity = FVector::ZeroVector;
+
+	//Rotation in 256ths of a turn, as the stock format sends it
+	uint8 Yaw = 0;
+	uint8 Pitch = 0;
+	uint8 Roll = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FMultiplayerRepMovement> : public TStructOpsTypeTraitsBase2<FMultiplayerRepMovement>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
+/**
+ * Character movement with the quantized, delta encoded client move format
+ */
+UCLASS()
+class MULTIPLAYER_PLUGIN_API UMultiplayerCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UMultiplayerCharacterMovementComponent(const FObjectInitializer& ObjectInitializer);
+
+	FQuantizedMoveCodec& GetMoveCodec() { return MoveCodec; }
+
+	//A pooled character changes hands, the next owner mustn't send moves relative to the previous one's
+	virtual void ResetPredictionData_Client() override;
+
+protected:
+
+	virtual void CallServerMovePacked(const FSavedMove_Character* NewMove, const FSavedMove_Character* PendingMove, const FSavedMove_Character* OldMove) override;
+
+private:
+
+	FQuantizedMoveCodec MoveCodec;
+	FMultiplayerCharacterNetworkMoveDataContainer MultiplayerMoveDataContainer;
+};
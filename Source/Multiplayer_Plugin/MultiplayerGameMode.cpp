@@ -4,9 +4,312 @@
 #include "MultiplayerGameMode.h"
 #include "GameFrameWork/PlayerState.h"
 #include "GameFramework/GameState.h"
+#include "GameFramework/GameSession.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "Multiplayer_PluginCharacter.h"
+#include "MultiplayerPlayerController.h"
+#include "TimerManager.h"
+#include "Misc/App.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+#include "Misc/PackageName.h"
+
+namespace
+{
+	//The lobby world and everything it references is collected in the transition map, so the preloaded match map is rooted
+	//until the match's game mode is up. Lives outside the game mode because neither world outlasts the travel
+	TWeakObjectPtr<UPackage> RootedMatchMap;
+
+	void ReleaseMatchMap()
+	{
+		if (UPackage* Package = RootedMatchMap.Get())
+		{
+			Package->RemoveFromRoot();
+		}
+		RootedMatchMap.Reset();
+	}
+
+	//PIE worlds live in UEDPIE_n_ copies of their package, compare maps by the name on disk
+	FString GetMapPackageName(const UWorld* World)
+	{
+		return UWorld::RemovePIEPrefix(World->GetOutermost()->GetName());
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice StartMatchCommand(
+		TEXT("Multiplayer.Match.Start"),
+		TEXT("Takes everyone in the lobby to the match map, or to the map given"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			AMultiplayerGameMode* GameMode = World ? World->GetAuthGameMode<AMultiplayerGameMode>() : nullptr;
+			if (GameMode)
+			{
+				GameMode->TravelToMatch(Args.Num() > 0 ? Args[0] : FString());
+			}
+		}));
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpAdmissionCommand(
+		TEXT("Multiplayer.Admission.Dump"),
+		TEXT("Prints depth, waits and throttling of the login admission queue"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			AMultiplayerGameMode* GameMode = World ? World->GetAuthGameMode<AMultiplayerGameMode>() : nullptr;
+			if (GameMode)
+			{
+				GameMode->DumpAdmissionQueue(Ar);
+			}
+		}));
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpCharacterPoolCommand(
+		TEXT("Multiplayer.CharacterPool.Dump"),
+		TEXT("Prints the character pool depth and spawn times from the pool against constructed characters"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			AMultiplayerGameMode* GameMode = World ? World->GetAuthGameMode<AMultiplayerGameMode>() : nullptr;
+			if (GameMode)
+			{
+				GameMode->DumpCharacterPool(Ar);
+			}
+		}));
+}
+
+AMultiplayerGameMode::AMultiplayerGameMode()
+{
+	//Samples frame times for the load report and lets queued players in
+	PrimaryActorTick.bCanEverTick = true;
+
+	//Lobby to match keeps every connection, clients load the match map behind the transition map
+	bUseSeamlessTravel = true;
+
+	//Returns disconnecting players' characters to the pool
+	PlayerControllerClass = AMultiplayerPlayerController::StaticClass();
+}
+
+void AMultiplayerGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	//Players register with the session this process hosts, a claimed warm session keeps its pool name
+	UMultiplayerSessionsSubsystem* Sessions = GetSessionsSubsystem();
+	if (Sessions && GameSession)
+	{
+		GameSession->SessionName = Sessions->GetHostedSessionName();
+	}
+}
+
+void AMultiplayerGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (GetNetMode() == NM_DedicatedServer && LoadReportIntervalSeconds > 0.0f)
+	{
+		GetWorldTimerManager().SetTimer(LoadReportTimer, this, &AMultiplayerGameMode::ReportServerLoad, LoadReportIntervalSeconds, true);
+	}
+
+	//A hard travel, as in PIE, arrives here with the map still rooted from the lobby
+	if (RootedMatchMap.IsValid() && RootedMatchMap->GetName() == GetMapPackageName(GetWorld()))
+	{
+		ReleaseMatchMap();
+	}
+
+	if (IsLobby())
+	{
+		PreloadMatchMap(MatchMapPath);
+	}
+
+	if ((GetNetMode() == NM_ListenServer || GetNetMode() == NM_DedicatedServer) && CharacterPoolSize > 0 && IsPooledClass(DefaultPawnClass))
+	{
+		PoolRefillTimer = GetWorldTimerManager().SetTimerForNextTick(this, &AMultiplayerGameMode::RefillCharacterPool);
+	}
+}
+
+void AMultiplayerGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(LoadReportTimer);
+	GetWorldTimerManager().ClearTimer(PoolRefillTimer);
+	GetWorldTimerManager().ClearTimer(StartMatchTimer);
+
+	//Only our own seamless travel still needs the preloaded map, any other map change or shutdown drops it
+	if (!bSeamlessTravelInFlight || EndPlayReason != EEndPlayReason::LevelTransition)
+	{
+		ReleaseMatchMap();
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+bool AMultiplayerGameMode::IsLobby() const
+{
+	return !MatchMapPath.IsEmpty() && FPackageName::ObjectPathToPackageName(MatchMapPath) != GetMapPackageName(GetWorld());
+}
+
+void AMultiplayerGameMode::CheckStartMatch(int32 NumPlayers)
+{
+	if (MinPlayersToStartMatch <= 0 || NumPlayers < MinPlayersToStartMatch || !IsLobby()
+		|| bSeamlessTravelInFlight || GetWorldTimerManager().IsTimerActive(StartMatchTimer))
+	{
+		return;
+	}
+
+	if (StartMatchDelaySeconds > 0.0f)
+	{
+		GetWorldTimerManager().SetTimer(StartMatchTimer, this, &AMultiplayerGameMode::StartMatch, StartMatchDelaySeconds);
+	}
+	else
+	{
+		StartMatch();
+	}
+}
+
+void AMultiplayerGameMode::StartMatch()
+{
+	TravelToMatch();
+}
+
+void AMultiplayerGameMode::TravelToMatch(const FString& MapPath)
+{
+	const FString TravelMapPath = MapPath.IsEmpty() ? MatchMapPath : MapPath;
+	if (TravelMapPath.IsEmpty() || bSeamlessTravelInFlight)
+	{
+		return;
+	}
+
+	if (TravelMapPath != PreloadedMapPath)
+	{
+		PendingTravelMapPath = TravelMapPath;
+		PreloadMatchMap(TravelMapPath);
+		return;
+	}
+
+	PendingTravelMapPath.Reset();
+	GetWorldTimerManager().ClearTimer(StartMatchTimer);
+
+	//PIE travels hard unless told otherwise, the match's BeginPlay releases the map then
+	const bool bTraveling = GetWorld()->ServerTravel(TravelMapPath);
+	bSeamlessTravelInFlight = bTraveling && bUseSeamlessTravel;
+}
+
+void AMultiplayerGameMode::PreloadMatchMap(const FString& MapPath)
+{
+	if (MapPath == PreloadingMapPath || MapPath == PreloadedMapPath)
+	{
+		return;
+	}
+
+	PreloadingMapPath = MapPath;
+	LoadPackageAsync(FPackageName::ObjectPathToPackageName(MapPath),
+		FLoadPackageAsyncDelegate::CreateUObject(this, &AMultiplayerGameMode::OnMatchMapPreloaded));
+}
+
+void AMultiplayerGameMode::OnMatchMapPreloaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result)
+{
+	//A later preload replaced this one
+	if (FPackageName::ObjectPathToPackageName(PreloadingMapPath) != PackageName.ToString())
+	{
+		return;
+	}
+
+	if (Result == EAsyncLoadingResult::Succeeded && Package)
+	{
+		ReleaseMatchMap();
+		Package->AddToRoot();
+		RootedMatchMap = Package;
+	}
+	else
+	{
+		//The travel loads it itself and reports the failure properly
+		UE_LOG(LogGameMode, Warning, TEXT("Preloading %s failed"), *PreloadingMapPath);
+	}
+
+	PreloadedMapPath = MoveTemp(PreloadingMapPath);
+	PreloadingMapPath.Reset();
+	if (PendingTravelMapPath == PreloadedMapPath)
+	{
+		TravelToMatch(PendingTravelMapPath);
+	}
+}
+
+void AMultiplayerGameMode::HandleSeamlessTravelPlayer(AController*& C)
+{
+	//Travelled players skip PostLogin, they are queued for admission through HandleStartingNewPlayer all the same
+	Super::HandleSeamlessTravelPlayer(C);
+
+	if (GameState)
+	{
+		ReportOccupancy(GameState->PlayerArray.Num());
+	}
+}
+
+void AMultiplayerGameMode::PostSeamlessTravel()
+{
+	Super::PostSeamlessTravel();
+	ReleaseMatchMap();
+}
+
+void AMultiplayerGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	//Undilated frame time, the idle part is what the server slept to hold its tick rate
+	const double FrameTime = FApp::GetDeltaTime();
+	const double BusyTime = FMath::Max(FrameTime - FApp::GetIdleTime(), 0.0);
+	FrameSeconds += FrameTime;
+	BusySeconds += BusyTime;
+	SmoothedBusyMs += (BusyTime * 1000.0 - SmoothedBusyMs) * 0.1;
+
+	if (PendingAdmissions.Num() > 0)
+	{
+		AdmitPendingPlayers();
+	}
+}
+
+void AMultiplayerGameMode::PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage)
+{
+	Super::PreLogin(Options, Address, UniqueId, ErrorMessage);
+
+	if (!ErrorMessage.IsEmpty() || MaxAdmissionQueueDepth <= 0)
+	{
+		return;
+	}
+
+	//Logins that dropped before PostLogin never give their slot back
+	const double Now = FPlatformTime::Seconds();
+	AdmissionReservations.RemoveAll([this, Now](const FAdmissionReservation& Reservation)
+	{
+		return Now - Reservation.ReservedTime > AdmissionReservationSeconds;
+	});
+
+	//Cheaper to turn them away before a controller exists than to let the queue grow without end
+	if (GetAdmissionQueueDepth() >= MaxAdmissionQueueDepth)
+	{
+		ErrorMessage = TEXT("Server is busy, try again shortly");
+		++AdmissionStats.Rejected;
+		return;
+	}
+
+	FAdmissionReservation& Reservation = AdmissionReservations.AddDefaulted_GetRef();
+	Reservation.UniqueId = UniqueId;
+	Reservation.ReservedTime = Now;
+}
+
+void AMultiplayerGameMode::ReleaseAdmissionReservation(const APlayerController* Player)
+{
+	const FUniqueNetIdRepl UniqueId = Player && Player->PlayerState ? Player->PlayerState->GetUniqueId() : FUniqueNetIdRepl();
+	const int32 Index = AdmissionReservations.IndexOfByPredicate([&UniqueId](const FAdmissionReservation& Reservation)
+	{
+		return Reservation.UniqueId == UniqueId;
+	});
+	if (Index != INDEX_NONE)
+	{
+		AdmissionReservations.RemoveAt(Index);
+	}
+}
 
 void AMultiplayerGameMode::PostLogin(APlayerController* NewPlayer)
 {
+	//Queued by HandleStartingNewPlayer during Super, the slot moves from the reservation to the queue
+	ReleaseAdmissionReservation(NewPlayer);
+
 	Super::PostLogin(NewPlayer);
 
 	if (GameState)
@@ -28,13 +331,24 @@ void AMultiplayerGameMode::PostLogin(APlayerController* NewPlayer)
 				);
 			}
 		}
+
+		ReportOccupancy(PlayerCount);
+		CheckStartMatch(PlayerCount);
 	}
 }
 
 void AMultiplayerGameMode::Logout(AController* Exiting)
 {
+	//Remote players' characters were pooled by their controller's PawnLeavingGame, this catches other controllers that still have one
+	ReleaseCharacter(Exiting);
+
 	Super::Logout(Exiting);
 
+	PendingAdmissions.RemoveAll([Exiting](const FPendingAdmission& Pending)
+	{
+		return Pending.Player.Get() == Exiting;
+	});
+
 	if (GameState)
 	{
 		int32 PlayerCount = GameState.Get()->PlayerArray.Num();
@@ -53,6 +367,234 @@ void AMultiplayerGameMode::Logout(AController* Exiting)
 					FString::Printf(TEXT("%s Has Left.\nTotal Players :: %d"), *LeftPlayerName, PlayerCount-1)
 				);
 			}
+
+			//The leaving player's state is still in the array until its controller is gone
+			--PlayerCount;
+		}
+
+		ReportOccupancy(PlayerCount);
+	}
+}
+
+void AMultiplayerGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	//The listen server's own player never waits
+	if (MaxAdmissionQueueDepth <= 0 || NewPlayer == nullptr || NewPlayer->IsLocalController())
+	{
+		Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+		return;
+	}
+
+	//Seamless travel brings players in here without PreLogin, so the queue may run past its depth after a map change
+	FPendingAdmission& Pending = PendingAdmissions.AddDefaulted_GetRef();
+	Pending.Player = NewPlayer;
+	Pending.QueuedTime = FPlatformTime::Seconds();
+	AdmissionStats.MaxQueueDepth = FMath::Max(AdmissionStats.MaxQueueDepth, PendingAdmissions.Num());
+}
+
+void AMultiplayerGameMode::AdmitPendingPlayers()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	int32 Budget = FMath::Max(AdmissionsPerTick, 1);
+	if (SmoothedBusyMs > AdmissionFrameBudgetMs)
+	{
+		//Backs off while spawns are still showing in the frame time, but never starves the front of the queue
+		++AdmissionStats.ThrottledTicks;
+		Budget = Now - PendingAdmissions[0].QueuedTime >= MaxAdmissionWaitSeconds ? 1 : 0;
+	}
+
+	//Spawning runs game code that may log players out, so the batch leaves the queue first
+	const int32 NumAdmitted = FMath::Min(Budget, PendingAdmissions.Num());
+	TArray<FPendingAdmission, TInlineAllocator<4>> Admitted(PendingAdmissions.GetData(), NumAdmitted);
+	PendingAdmissions.RemoveAt(0, NumAdmitted, false);
+
+	for (const FPendingAdmission& Pending : Admitted)
+	{
+		if (APlayerController* Player = Pending.Player.Get())
+		{
+			AdmitPlayer(Player, Pending.QueuedTime, Now);
+		}
+	}
+}
+
+void AMultiplayerGameMode::AdmitPlayer(APlayerController* Player, double QueuedTime, double Now)
+{
+	const double Wait = Now - QueuedTime;
+	++AdmissionStats.Admitted;
+	AdmissionStats.LastWait = Wait;
+	AdmissionStats.TotalWait += Wait;
+	AdmissionStats.MaxWait = FMath::Max(AdmissionStats.MaxWait, Wait);
+
+	Super::HandleStartingNewPlayer_Implementation(Player);
+}
+
+double AMultiplayerGameMode::GetOldestAdmissionWait() const
+{
+	return PendingAdmissions.Num() > 0 ? FPlatformTime::Seconds() - PendingAdmissions[0].QueuedTime : 0.0;
+}
+
+void AMultiplayerGameMode::DumpAdmissionQueue(FOutputDevice& Ar) const
+{
+	const FPlayerAdmissionStats& Stats = AdmissionStats;
+	Ar.Logf(TEXT("Admission queue: %d/%d waiting, %d logging in, oldest %.1fs, frame %.1fms of %.1fms budget"),
+		PendingAdmissions.Num(), MaxAdmissionQueueDepth, AdmissionReservations.Num(), GetOldestAdmissionWait(), SmoothedBusyMs, AdmissionFrameBudgetMs);
+	Ar.Logf(TEXT("  admitted %d, rejected %d, throttled ticks %d, max depth %d"),
+		Stats.Admitted, Stats.Rejected, Stats.ThrottledTicks, Stats.MaxQueueDepth);
+	Ar.Logf(TEXT("  wait last %.2fs, mean %.2fs, max %.2fs"),
+		Stats.LastWait, Stats.GetAverageWait(), Stats.MaxWait);
+}
+
+APawn* AMultiplayerGameMode::SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	AMultiplayer_PluginCharacter* Pooled = nullptr;
+	if (GetDefaultPawnClassForController(NewPlayer) == DefaultPawnClass)
+	{
+		while (!Pooled && PooledCharacters.Num() > 0)
+		{
+			AMultiplayer_PluginCharacter* Character = PooledCharacters.Pop(false);
+			Pooled = IsValid(Character) ? Character : nullptr;
+		}
+	}
+
+	APawn* Pawn = nullptr;
+	if (Pooled)
+	{
+		Pooled->LeavePool(SpawnTransform);
+		Pawn = Pooled;
+	}
+	else
+	{
+		Pawn = Super::SpawnDefaultPawnAtTransform_Implementation(NewPlayer, SpawnTransform);
+	}
+
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	if (Pooled)
+	{
+		++SpawnStats.Pooled;
+		SpawnStats.LastPooledMs = ElapsedMs;
+		SpawnStats.TotalPooledMs += ElapsedMs;
+		SpawnStats.MaxPooledMs = FMath::Max(SpawnStats.MaxPooledMs, ElapsedMs);
+	}
+	else
+	{
+		++SpawnStats.Constructed;
+		SpawnStats.LastConstructedMs = ElapsedMs;
+		SpawnStats.TotalConstructedMs += ElapsedMs;
+		SpawnStats.MaxConstructedMs = FMath::Max(SpawnStats.MaxConstructedMs, ElapsedMs);
+	}
+
+	if (Pooled && !GetWorldTimerManager().IsTimerActive(PoolRefillTimer))
+	{
+		PoolRefillTimer = GetWorldTimerManager().SetTimerForNextTick(this, &AMultiplayerGameMode::RefillCharacterPool);
+	}
+
+	return Pawn;
+}
+
+void AMultiplayerGameMode::RespawnPlayer(AController* Player)
+{
+	if (!Player)
+	{
+		return;
+	}
+
+	APawn* OldPawn = Player->GetPawn();
+	if (OldPawn && !ReleaseCharacter(Player))
+	{
+		Player->UnPossess();
+		OldPawn->Destroy();
+	}
+
+	RestartPlayer(Player);
+}
+
+bool AMultiplayerGameMode::IsPooledClass(UClass* PawnClass) const
+{
+	return PawnClass && PawnClass->IsChildOf(AMultiplayer_PluginCharacter::StaticClass());
+}
+
+bool AMultiplayerGameMode::ReleaseCharacter(AController* Controller)
+{
+	AMultiplayer_PluginCharacter* Character = Controller ? Cast<AMultiplayer_PluginCharacter>(Controller->GetPawn()) : nullptr;
+	if (!Character || Character->GetClass() != DefaultPawnClass || PooledCharacters.Num() >= CharacterPoolSize)
+	{
+		return false;
+	}
+
+	Controller->UnPossess();
+	Character->EnterPool(PoolParkingLocation);
+	PooledCharacters.Push(Character);
+	return true;
+}
+
+void AMultiplayerGameMode::RefillCharacterPool()
+{
+	if (PooledCharacters.Num() >= CharacterPoolSize || !IsPooledClass(DefaultPawnClass))
+	{
+		return;
+	}
+
+	//A construction is the hitch the pool exists to avoid, it waits for a frame with room
+	if (SmoothedBusyMs <= AdmissionFrameBudgetMs)
+	{
+		const FTransform ParkingTransform(PoolParkingLocation);
+		AMultiplayer_PluginCharacter* Character = GetWorld()->SpawnActorDeferred<AMultiplayer_PluginCharacter>(
+			DefaultPawnClass, ParkingTransform, nullptr, GetInstigator(), ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+
+		if (Character)
+		{
+			//Clients don't hear of it before its first player
+			Character->NetDormancy = DORM_Initial;
+			Character->FinishSpawning(ParkingTransform);
+			Character->EnterPool(PoolParkingLocation);
+			PooledCharacters.Push(Character);
 		}
 	}
-}
\ No newline at end of file
+
+	if (PooledCharacters.Num() < CharacterPoolSize)
+	{
+		PoolRefillTimer = GetWorldTimerManager().SetTimerForNextTick(this, &AMultiplayerGameMode::RefillCharacterPool);
+	}
+}
+
+void AMultiplayerGameMode::DumpCharacterPool(FOutputDevice& Ar) const
+{
+	const FCharacterSpawnStats& Stats = SpawnStats;
+	Ar.Logf(TEXT("Character pool: %d/%d ready"), PooledCharacters.Num(), CharacterPoolSize);
+	Ar.Logf(TEXT("  from pool %d, last %.2fms, mean %.2fms, max %.2fms"),
+		Stats.Pooled, Stats.LastPooledMs, Stats.GetAveragePooledMs(), Stats.MaxPooledMs);
+	Ar.Logf(TEXT("  constructed %d, last %.2fms, mean %.2fms, max %.2fms"),
+		Stats.Constructed, Stats.LastConstructedMs, Stats.GetAverageConstructedMs(), Stats.MaxConstructedMs);
+}
+
+UMultiplayerSessionsSubsystem* AMultiplayerGameMode::GetSessionsSubsystem() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr;
+}
+
+void AMultiplayerGameMode::ReportOccupancy(int32 NumPlayers)
+{
+	if (UMultiplayerSessionsSubsystem* Sessions = GetSessionsSubsystem())
+	{
+		Sessions->ReportSessionOccupancy(NumPlayers, ServerLoad);
+	}
+}
+
+void AMultiplayerGameMode::ReportServerLoad()
+{
+	if (FrameSeconds > 0.0)
+	{
+		ServerLoad = FMath::Clamp(FMath::RoundToInt(100.0 * BusySeconds / FrameSeconds), 0, 100);
+		BusySeconds = 0.0;
+		FrameSeconds = 0.0;
+	}
+
+	if (GameState)
+	{
+		ReportOccupancy(GameState->PlayerArray.Num());
+	}
+}
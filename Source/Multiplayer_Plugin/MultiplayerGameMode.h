@@ -4,18 +4,233 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
+#include "GameFramework/OnlineReplStructs.h"
 #include "MultiplayerGameMode.generated.h"
 
+class UMultiplayerSessionsSubsystem;
+class AMultiplayer_PluginCharacter;
+
+/**
+ * Counters for the login admission queue
+ */
+struct FPlayerAdmissionStats
+{
+	int32 Admitted = 0;
+
+	//Turned away at PreLogin because the queue was full
+	int32 Rejected = 0;
+
+	//Ticks with players waiting that admitted nobody because the frame was over budget
+	int32 ThrottledTicks = 0;
+	int32 MaxQueueDepth = 0;
+
+	//Seconds from PostLogin to the player being spawned
+	double LastWait = 0.0;
+	double TotalWait = 0.0;
+	double MaxWait = 0.0;
+
+	double GetAverageWait() const
+	{
+		return Admitted > 0 ? TotalWait / Admitted : 0.0;
+	}
+};
+
+/**
+ * Time SpawnDefaultPawnFor took, for characters handed out of the pool and ones constructed because it was empty
+ */
+struct FCharacterSpawnStats
+{
+	int32 Pooled = 0;
+	int32 Constructed = 0;
+
+	double LastPooledMs = 0.0;
+	double TotalPooledMs = 0.0;
+	double MaxPooledMs = 0.0;
+
+	double LastConstructedMs = 0.0;
+	double TotalConstructedMs = 0.0;
+	double MaxConstructedMs = 0.0;
+
+	double GetAveragePooledMs() const
+	{
+		return Pooled > 0 ? TotalPooledMs / Pooled : 0.0;
+	}
+
+	double GetAverageConstructedMs() const
+	{
+		return Constructed > 0 ? TotalConstructedMs / Constructed : 0.0;
+	}
+};
+
 /**
- * 
+ * Spawns joining players a few per tick instead of all in the frame a lobby fills.
+ * Players wait logged in but without a pawn until the admission queue lets them in.
  */
 UCLASS()
 class MULTIPLAYER_PLUGIN_API AMultiplayerGameMode : public AGameModeBase
 {
 	GENERATED_BODY()
-	
+
+public:
+	AMultiplayerGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	//Players waiting for a pawn plus logins that passed PreLogin and have no controller yet
+	int32 GetAdmissionQueueDepth() const { return PendingAdmissions.Num() + AdmissionReservations.Num(); }
+
+	//Seconds the player at the front of the queue has waited so far, 0 when nobody waits
+	double GetOldestAdmissionWait() const;
+	const FPlayerAdmissionStats& GetAdmissionStats() const { return AdmissionStats; }
+
+	//Queue depth, waits and throttling, also printed by "Multiplayer.Admission.Dump"
+	void DumpAdmissionQueue(FOutputDevice& Ar) const;
+
+	/**
+	 * Takes everyone to the match map through the transition map without dropping their connections.
+	 * Goes out once the preload of the map finished, right away when it already has.
+	 * @param MapPath	Map to travel to, empty uses MatchMapPath
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Travel")
+	void TravelToMatch(const FString& MapPath = TEXT(""));
+
+	//True in a lobby, a world of this game mode with a match map to go to that isn't the match itself
+	bool IsLobby() const;
+
+	/** Returns the player's character to the pool and spawns them again at a player start */
+	UFUNCTION(BlueprintCallable, Category = "Spawning")
+	void RespawnPlayer(AController* Player);
+
+	//Pools the controller's character and leaves it without a pawn, false when the character can't be pooled.
+	//AMultiplayerPlayerController calls it for players who disconnect, before the engine would destroy the character
+	bool ReleaseCharacter(AController* Controller);
+
+	int32 GetCharacterPoolDepth() const { return PooledCharacters.Num(); }
+	const FCharacterSpawnStats& GetSpawnStats() const { return SpawnStats; }
+
+	//Pool depth and spawn times from the pool against constructed ones, also printed by "Multiplayer.CharacterPool.Dump"
+	void DumpCharacterPool(FOutputDevice& Ar) const;
 
 protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void PostLogin(APlayerController* NewPlayer) override;
 	virtual void Logout(AController* Exiting) override;
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+	virtual void HandleSeamlessTravelPlayer(AController*& C) override;
+	virtual void PostSeamlessTravel() override;
+	virtual APawn* SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform) override;
+
+	//Map TravelToMatch goes to, loaded in the background as soon as the lobby is up. Set by lobby game modes only, empty preloads nothing
+	UPROPERTY(EditDefaultsOnly, Category = "Travel")
+	FString MatchMapPath;
+
+	//Players in the lobby that start the match on their own, 0 waits for TravelToMatch or "Multiplayer.Match.Start"
+	UPROPERTY(EditDefaultsOnly, Category = "Travel")
+	int32 MinPlayersToStartMatch = 0;
+
+	//Seconds between the lobby filling up and the travel, players joining meanwhile still go along
+	UPROPERTY(EditDefaultsOnly, Category = "Travel")
+	float StartMatchDelaySeconds = 5.0f;
+
+	//Characters of the default pawn class kept spawned and dormant for joins and respawns, 0 constructs every one
+	UPROPERTY(EditDefaultsOnly, Category = "Spawning")
+	int32 CharacterPoolSize = 8;
+
+	//Where pooled characters wait, out of every player's cull distance
+	UPROPERTY(EditDefaultsOnly, Category = "Spawning")
+	FVector PoolParkingLocation = FVector(0.0f, 0.0f, -50000.0f);
+
+	//Seconds between server load reports, joins and leaves are reported as they happen
+	UPROPERTY(EditDefaultsOnly, Category = "Session")
+	float LoadReportIntervalSeconds = 5.0f;
+
+	//Players waiting for a pawn beyond this are turned away at PreLogin, 0 spawns everyone right away
+	UPROPERTY(EditDefaultsOnly, Category = "Admission")
+	int32 MaxAdmissionQueueDepth = 64;
+
+	//Players spawned per tick while the server keeps up
+	UPROPERTY(EditDefaultsOnly, Category = "Admission")
+	int32 AdmissionsPerTick = 2;
+
+	//Smoothed busy frame time in ms above which admissions pause
+	UPROPERTY(EditDefaultsOnly, Category = "Admission")
+	float AdmissionFrameBudgetMs = 20.0f;
+
+	//The front of the queue gets in after this long even while the server is over budget
+	UPROPERTY(EditDefaultsOnly, Category = "Admission")
+	float MaxAdmissionWaitSeconds = 10.0f;
+
+	//A slot held at PreLogin is given up after this long when the login never reached PostLogin
+	UPROPERTY(EditDefaultsOnly, Category = "Admission")
+	float AdmissionReservationSeconds = 30.0f;
+
+private:
+	UMultiplayerSessionsSubsystem* GetSessionsSubsystem() const;
+
+	//The subsystem coalesces reports, so calling this on every join and leave is cheap
+	void ReportOccupancy(int32 NumPlayers);
+	void ReportServerLoad();
+
+	void PreloadMatchMap(const FString& MapPath);
+
+	//Starts the countdown to the match once the lobby has MinPlayersToStartMatch players
+	void CheckStartMatch(int32 NumPlayers);
+	void StartMatch();
+	void OnMatchMapPreloaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result);
+
+	//Constructs one pooled character per tick until the pool is full, waits while the frame is over the admission budget
+	void RefillCharacterPool();
+
+	bool IsPooledClass(UClass* PawnClass) const;
+
+	void AdmitPendingPlayers();
+
+	//Gives back the slot PreLogin held for this player, the oldest one when several share an id
+	void ReleaseAdmissionReservation(const APlayerController* Player);
+	void AdmitPlayer(APlayerController* Player, double QueuedTime, double Now);
+
+	//Percent of the frame budget spent working since the last load report. Only dedicated servers sleep to hold their tick rate,
+	//listen servers always look fully loaded and leave it out
+	FTimerHandle LoadReportTimer;
+	int32 ServerLoad = INDEX_NONE;
+	double BusySeconds = 0.0;
+	double FrameSeconds = 0.0;
+
+	//Seamless Travel, a map asked for before its preload finished goes out from the preload's callback
+	FString PreloadingMapPath;
+	FString PreloadedMapPath;
+	FString PendingTravelMapPath;
+	FTimerHandle StartMatchTimer;
+
+	//Set once the seamless travel went out, the preloaded map has to outlive this world then
+	bool bSeamlessTravelInFlight = false;
+
+	//Login Admission, oldest first
+	struct FPendingAdmission
+	{
+		TWeakObjectPtr<APlayerController> Player;
+		double QueuedTime = 0.0;
+	};
+	TArray<FPendingAdmission> PendingAdmissions;
+	FPlayerAdmissionStats AdmissionStats;
+
+	//Slots held from PreLogin to PostLogin, so a burst of logins can't all pass the depth check before any is queued
+	struct FAdmissionReservation
+	{
+		FUniqueNetIdRepl UniqueId;
+		double ReservedTime = 0.0;
+	};
+	TArray<FAdmissionReservation> AdmissionReservations;
+
+	//Busy frame time smoothed over a few frames, one slow frame shouldn't stall the queue
+	double SmoothedBusyMs = 0.0;
+
+	//Character Pool, most recently pooled last
+	UPROPERTY()
+	TArray<AMultiplayer_PluginCharacter*> PooledCharacters;
+	FTimerHandle PoolRefillTimer;
+	FCharacterSpawnStats SpawnStats;
 };
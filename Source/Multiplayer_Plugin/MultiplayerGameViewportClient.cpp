@@ -0,0 +1,16 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerGameViewportClient.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+UMultiplayerGameViewportClient::UMultiplayerGameViewportClient(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	int32 NumBots = 0;
+	if (FParse::Value(FCommandLine::Get(), TEXT("Bots="), NumBots))
+	{
+		MaxSplitscreenPlayers = FMath::Max(MaxSplitscreenPlayers, NumBots);
+	}
+}
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/GameViewportClient.h"
+#include "MultiplayerGameViewportClient.generated.h"
+
+/**
+ * Lets a bot client started with -Bots=N add that many splitscreen players, the engine stops at four.
+ * Players get the engine's limit otherwise.
+ */
+UCLASS()
+class MULTIPLAYER_PLUGIN_API UMultiplayerGameViewportClient : public UGameViewportClient
+{
+	GENERATED_BODY()
+
+public:
+	UMultiplayerGameViewportClient(const FObjectInitializer& ObjectInitializer);
+};
@@ -0,0 +1,236 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerNetFrequencySubsystem.h"
+#include "Multiplayer_PluginCharacter.h"
+#include "MultiplayerReplicationGraph.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpNetFrequencyCommand(
+		TEXT("Multiplayer.NetFrequency.Dump"),
+		TEXT("Prints character net update rates, bandwidth budget use and the bandwidth saved"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UMultiplayerNetFrequencySubsystem* NetFrequency = World ? World->GetSubsystem<UMultiplayerNetFrequencySubsystem>() : nullptr;
+			if (NetFrequency)
+			{
+				NetFrequency->DumpNetFrequencies(Ar);
+			}
+		}));
+
+	struct FFrequencyCandidate
+	{
+		AMultiplayer_PluginCharacter* Character = nullptr;
+		float WantedFrequency = 0.0f;
+		float DefaultFrequency = 0.0f;
+
+		//Bytes per net tick one update per second costs, for every connection the character is sent to
+		double BytesPerTickPerHz = 0.0;
+	};
+}
+
+bool UMultiplayerNetFrequencySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return Super::ShouldCreateSubsystem(Outer) && World && World->IsGameWorld();
+}
+
+void UMultiplayerNetFrequencySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	const ENetMode NetMode = InWorld.GetNetMode();
+	if (NetMode == NM_Client || NetMode == NM_Standalone)
+	{
+		return;
+	}
+
+	LastUpdateTime = FPlatformTime::Seconds();
+	InWorld.GetTimerManager().SetTimer(UpdateTimer, this, &ThisClass::UpdateFrequencies, FMath::Max(UpdateIntervalSeconds, 0.05f), true);
+}
+
+void UMultiplayerNetFrequencySubsystem::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(UpdateTimer);
+	}
+
+	Activities.Reset();
+	Super::Deinitialize();
+}
+
+void UMultiplayerNetFrequencySubsystem::UpdateFrequencies()
+{
+	UWorld* World = GetWorld();
+	UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+	if (!NetDriver)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const double ElapsedSeconds = Now - LastUpdateTime;
+	LastUpdateTime = Now;
+
+	//Rates above the server's tick rate can't be sent any faster
+	const float TickRate = FMath::Max<float>(NetDriver->NetServerMaxTickRate, 1.0f);
+	const float MinFrequency = FMath::Clamp(MinNetUpdateFrequency, 0.1f, TickRate);
+	const float MaxFrequency = FMath::Clamp(MaxNetUpdateFrequency, MinFrequency, TickRate);
+	const float FarDistanceSquared = FMath::Square(FarViewerDistance);
+
+	//Remote players only, the listen server's own view costs no bandwidth
+	TArray<TPair<const AController*, FVector>> Viewers;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* Player = It->Get();
+		const AActor* ViewTarget = Player && !Player->IsLocalController() ? Player->GetViewTarget() : nullptr;
+		if (ViewTarget)
+		{
+			Viewers.Emplace(Player, ViewTarget->GetActorLocation());
+		}
+	}
+
+	TArray<FFrequencyCandidate> Candidates;
+	double WantedBytesPerTick = 0.0;
+	double MinBytesPerTick = 0.0;
+	double DefaultBytesPerTick = 0.0;
+
+	for (TActorIterator<AMultiplayer_PluginCharacter> It(World); It; ++It)
+	{
+		AMultiplayer_PluginCharacter* Character = *It;
+		const UCharacterMovementComponent* Movement = Character->GetCharacterMovement();
+
+		//Pooled characters are dormant, a forced update would wake them
+		if (!Character->GetIsReplicated() || !Movement || Character->IsPooled())
+		{
+			continue;
+		}
+
+		//The server sees its clients' input as the acceleration and control rotation of their moves
+		FCharacterActivity& Activity = Activities.FindOrAdd(Character);
+		const FRotator ControlRotation = Character->GetControlRotation();
+		if (!Movement->GetCurrentAcceleration().IsNearlyZero() || Character->bPressedJump || !ControlRotation.Equals(Activity.LastControlRotation, 1.0f))
+		{
+			Activity.LastInputTime = Now;
+		}
+		Activity.LastControlRotation = ControlRotation;
+
+		const float MotionFactor = FMath::Clamp(Character->GetVelocity().Size() / FMath::Max(Movement->GetMaxSpeed(), 1.0f), 0.0f, 1.0f);
+		const float InputFactor = InputActiveSeconds > 0.0f ? FMath::Clamp(1.0f - float(Now - Activity.LastInputTime) / InputActiveSeconds, 0.0f, 1.0f) : 0.0f;
+
+		//Nearest other player, and how many are close enough to be sent the character at all
+		float NearestDistanceSquared = MAX_flt;
+		int32 NumViewers = 0;
+		for (const TPair<const AController*, FVector>& Viewer : Viewers)
+		{
+			if (Viewer.Key == Character->GetController())
+			{
+				continue;
+			}
+
+			const float DistanceSquared = FVector::DistSquared(Viewer.Value, Character->GetActorLocation());
+			NearestDistanceSquared = FMath::Min(NearestDistanceSquared, DistanceSquared);
+			NumViewers += DistanceSquared <= FarDistanceSquared ? 1 : 0;
+		}
+
+		const float ProximityFactor = NumViewers > 0
+			? 1.0f - FMath::Clamp((FMath::Sqrt(NearestDistanceSquared) - NearViewerDistance) / FMath::Max(FarViewerDistance - NearViewerDistance, 1.0f), 0.0f, 1.0f)
+			: 0.0f;
+
+		FFrequencyCandidate& Candidate = Candidates.AddDefaulted_GetRef();
+		Candidate.Character = Character;
+		Candidate.WantedFrequency = FMath::Lerp(MinFrequency, MaxFrequency, FMath::Max(MotionFactor, InputFactor) * ProximityFactor);
+		Candidate.DefaultFrequency = FMath::Min(Character->GetClass()->GetDefaultObject<AActor>()->NetUpdateFrequency, TickRate);
+		Candidate.BytesPerTickPerHz = double(BytesPerUpdateEstimate) * NumViewers / TickRate;
+
+		WantedBytesPerTick += Candidate.WantedFrequency * Candidate.BytesPerTickPerHz;
+		MinBytesPerTick += MinFrequency * Candidate.BytesPerTickPerHz;
+		DefaultBytesPerTick += Candidate.DefaultFrequency * Candidate.BytesPerTickPerHz;
+	}
+
+	//Over budget, everyone gives up the same share of what they wanted above the minimum. When even the minimums
+	//don't fit, those are scaled down too, the budget is never exceeded
+	const double Budget = FMath::Max(BandwidthBudgetBytesPerTick, 0);
+	double AboveMinimumScale = 1.0;
+	double MinimumScale = 1.0;
+	if (WantedBytesPerTick > Budget)
+	{
+		++Stats.BudgetLimitedUpdates;
+		if (MinBytesPerTick < Budget)
+		{
+			AboveMinimumScale = (Budget - MinBytesPerTick) / (WantedBytesPerTick - MinBytesPerTick);
+		}
+		else
+		{
+			AboveMinimumScale = 0.0;
+			MinimumScale = Budget / MinBytesPerTick;
+		}
+	}
+
+	UMultiplayerReplicationGraph* Graph = UMultiplayerReplicationGraph::GetForWorld(World);
+	double UsedBytesPerTick = 0.0;
+	double FrequencySum = 0.0;
+
+	for (const FFrequencyCandidate& Candidate : Candidates)
+	{
+		const float Frequency = FMath::Max(float((MinFrequency + (Candidate.WantedFrequency - MinFrequency) * AboveMinimumScale) * MinimumScale), 0.1f);
+		UsedBytesPerTick += Frequency * Candidate.BytesPerTickPerHz;
+		FrequencySum += Frequency;
+
+		AMultiplayer_PluginCharacter* Character = Candidate.Character;
+		FCharacterActivity& Activity = Activities.FindChecked(Character);
+		Character->NetUpdateFrequency = Frequency;
+		Character->MinNetUpdateFrequency = FMath::Min(Character->MinNetUpdateFrequency, Frequency);
+
+		//Connections are only walked when the rate in net frames actually changes
+		const uint32 ReplicationPeriodFrame = FMath::Clamp<uint32>(FMath::RoundToInt(TickRate / Frequency), 1, MAX_uint16);
+		if (Graph && ReplicationPeriodFrame != Activity.ReplicationPeriodFrame)
+		{
+			Graph->SetActorReplicationPeriod(Character, ReplicationPeriodFrame);
+		}
+		Activity.ReplicationPeriodFrame = ReplicationPeriodFrame;
+
+		//A character waking up shouldn't wait out the idle rate's next update
+		if (Frequency > Activity.Frequency * 2.0f)
+		{
+			Character->ForceNetUpdate();
+		}
+		Activity.Frequency = Frequency;
+	}
+
+	for (auto It = Activities.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	++Stats.Updates;
+	Stats.LastBytesPerTick = UsedBytesPerTick;
+	Stats.MaxBytesPerTick = FMath::Max(Stats.MaxBytesPerTick, UsedBytesPerTick);
+	Stats.LastSavedBytesPerSecond = FMath::Max(DefaultBytesPerTick - UsedBytesPerTick, 0.0) * TickRate;
+	Stats.TotalSavedBytes += Stats.LastSavedBytesPerSecond * ElapsedSeconds;
+	Stats.TotalSeconds += ElapsedSeconds;
+	Stats.LastAverageFrequency = Candidates.Num() > 0 ? FrequencySum / Candidates.Num() : 0.0;
+}
+
+void UMultiplayerNetFrequencySubsystem::DumpNetFrequencies(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Net frequency: %d characters at %.1fHz on average, %.1f-%.1fHz, updated every %.2fs"),
+		Activities.Num(), Stats.LastAverageFrequency, MinNetUpdateFrequency, MaxNetUpdateFrequency, UpdateIntervalSeconds);
+	Ar.Logf(TEXT("  budget %d bytes/tick, using %.0f, max %.0f, limited %d of %d updates"),
+		BandwidthBudgetBytesPerTick, Stats.LastBytesPerTick, Stats.MaxBytesPerTick, Stats.BudgetLimitedUpdates, Stats.Updates);
+	Ar.Logf(TEXT("  saved against default rates: %.1f KB/s now, %.1f KB/s mean, %.1f MB in %.0fs"),
+		Stats.LastSavedBytesPerSecond / 1024.0, Stats.GetAverageSavedBytesPerSecond() / 1024.0, Stats.TotalSavedBytes / (1024.0 * 1024.0), Stats.TotalSeconds);
+	Ar.Logf(TEXT("  estimated at %d bytes per update and connection"), BytesPerUpdateEstimate);
+}
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "MultiplayerNetFrequencySubsystem.generated.h"
+
+class AMultiplayer_PluginCharacter;
+
+/**
+ * Estimated character replication cost, against the budget and against every character replicating at its default rate
+ */
+struct FNetFrequencyStats
+{
+	int32 Updates = 0;
+
+	//Updates where the wanted rates didn't fit the budget and were all scaled down
+	int32 BudgetLimitedUpdates = 0;
+
+	//Bytes per net tick the characters were given
+	double LastBytesPerTick = 0.0;
+	double MaxBytesPerTick = 0.0;
+
+	//Bytes per second below the default rates, summed over the time the subsystem ran
+	double LastSavedBytesPerSecond = 0.0;
+	double TotalSavedBytes = 0.0;
+	double TotalSeconds = 0.0;
+
+	double LastAverageFrequency = 0.0;
+
+	double GetAverageSavedBytesPerSecond() const
+	{
+		return TotalSeconds > 0.0 ? TotalSavedBytes / TotalSeconds : 0.0;
+	}
+};
+
+/**
+ * Server side, picks every character's net update frequency from how fast it moves, how recently its player gave input
+ * and how close the nearest other player is. All characters together stay inside a bandwidth budget per net tick.
+ */
+UCLASS(Config = Game)
+class MULTIPLAYER_PLUGIN_API UMultiplayerNetFrequencySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	const FNetFrequencyStats& GetStats() const { return Stats; }
+
+	//Rates, budget use and savings, also printed by "Multiplayer.NetFrequency.Dump"
+	void DumpNetFrequencies(FOutputDevice& Ar) const;
+
+protected:
+
+	//Seconds between rate updates, input that wakes a character up is noticed at most this late
+	UPROPERTY(Config)
+	float UpdateIntervalSeconds = 0.25f;
+
+	//Rate of idle characters and ones nobody is near, and of moving ones close to someone
+	UPROPERTY(Config)
+	float MinNetUpdateFrequency = 2.0f;
+
+	UPROPERTY(Config)
+	float MaxNetUpdateFrequency = 30.0f;
+
+	//Other players closer than this get the full rate, beyond the far distance they aren't sent the character at all
+	UPROPERTY(Config)
+	float NearViewerDistance = 2000.0f;
+
+	UPROPERTY(Config)
+	float FarViewerDistance = 15000.0f;
+
+	//Input keeps a character at the full rate for this long after it stops, the rate drops as it fades
+	UPROPERTY(Config)
+	float InputActiveSeconds = 2.0f;
+
+	//Bytes one character update costs per connection it is sent to, movement and its headers
+	UPROPERTY(Config)
+	int32 BytesPerUpdateEstimate = 32;
+
+	//Bytes per net tick all character updates together may take, rates are scaled down to fit
+	UPROPERTY(Config)
+	int32 BandwidthBudgetBytesPerTick = 65536;
+
+private:
+
+	void UpdateFrequencies();
+
+	struct FCharacterActivity
+	{
+		FRotator LastControlRotation = FRotator::ZeroRotator;
+		double LastInputTime = -MAX_dbl;
+		float Frequency = 0.0f;
+		uint32 ReplicationPeriodFrame = 0;
+	};
+	TMap<TWeakObjectPtr<AMultiplayer_PluginCharacter>, FCharacterActivity> Activities;
+
+	FTimerHandle UpdateTimer;
+	double LastUpdateTime = 0.0;
+	FNetFrequencyStats Stats;
+};
@@ -0,0 +1,18 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerPlayerController.h"
+#include "MultiplayerGameMode.h"
+#include "Engine/World.h"
+
+void AMultiplayerPlayerController::PawnLeavingGame()
+{
+	//Called from Destroyed on the server when the connection closes, the pawn is still possessed here
+	AMultiplayerGameMode* GameMode = GetWorld() ? GetWorld()->GetAuthGameMode<AMultiplayerGameMode>() : nullptr;
+	if (GameMode && GameMode->ReleaseCharacter(this))
+	{
+		return;
+	}
+
+	Super::PawnLeavingGame();
+}
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "MultiplayerPlayerController.generated.h"
+
+/**
+ * Hands the character of a player who disconnects back to the game mode's pool instead of destroying it.
+ * The engine gets rid of the pawn before Logout, so the game mode can't reclaim it there.
+ */
+UCLASS()
+class MULTIPLAYER_PLUGIN_API AMultiplayerPlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void PawnLeavingGame() override;
+};
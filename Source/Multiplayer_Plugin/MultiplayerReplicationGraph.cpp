@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MultiplayerReplicationGraph.h"
+#include "Multiplayer_PluginCharacter.h"
+#include "ReplicationGraphTypes.h"
+#include "ReplicationGraph.h"
+#include "GameFramework/PlayerState.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+namespace
+{
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpReplicationCommand(
+		TEXT("Multiplayer.RepGraph.Dump"),
+		TEXT("Prints replication time per net tick by connection count"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (UMultiplayerReplicationGraph* Graph = UMultiplayerReplicationGraph::GetForWorld(World))
+			{
+				Graph->DumpReplicationStats(Ar);
+			}
+		}));
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice ResetReplicationCommand(
+		TEXT("Multiplayer.RepGraph.Reset"),
+		TEXT("Clears the replication time measurements, for a fresh run at another player count"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			if (UMultiplayerReplicationGraph* Graph = UMultiplayerReplicationGraph::GetForWorld(World))
+			{
+				Graph->ResetReplicationStats();
+			}
+		}));
+}
+
+UMultiplayerReplicationGraph* UMultiplayerReplicationGraph::GetForWorld(const UWorld* World)
+{
+	UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+	return NetDriver ? Cast<UMultiplayerReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+}
+
+void UMultiplayerReplicationGraph::SetActorReplicationPeriod(AActor* Actor, uint32 ReplicationPeriodFrame)
+{
+	FGlobalActorReplicationInfo* GlobalInfo = GlobalActorReplicationInfoMap.Find(Actor);
+	if (!GlobalInfo)
+	{
+		return;
+	}
+
+	//Connections copy the period when they first see the actor, the ones that already have must be told
+	GlobalInfo->Settings.ReplicationPeriodFrame = ReplicationPeriodFrame;
+	for (UNetReplicationGraphConnection* Connection : Connections)
+	{
+		if (FConnectionReplicationActorInfo* ConnectionInfo = Connection->ActorInfoMap.Find(Actor))
+		{
+			ConnectionInfo->ReplicationPeriodFrame = ReplicationPeriodFrame;
+
+			//A faster rate shouldn't wait out the slow one's remaining frames
+			ConnectionInfo->NextReplicationFrameNum = FMath::Min<uint32>(ConnectionInfo->NextReplicationFrameNum, ConnectionInfo->LastRepFrameNum + ReplicationPeriodFrame);
+		}
+	}
+}
+
+void UMultiplayerReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	//The basic graph took the cull distance from each class, characters use ours. Blueprint children loaded later find it on their parent
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		if (!Class->IsChildOf(AMultiplayer_PluginCharacter::StaticClass()) || Class->HasAnyClassFlags(CLASS_Abstract | CLASS_NewerVersionExists))
+		{
+			continue;
+		}
+
+		const AActor* CharacterCDO = GetDefault<AActor>(Class);
+		FClassReplicationInfo CharacterInfo;
+		CharacterInfo.SetCullDistanceSquared(FMath::Square(CharacterCullDistance));
+		//A zero or negative frequency from a Blueprint child would divide by zero, treat it as the slowest sensible rate
+		const float NetUpdateFrequency = FMath::Max(CharacterCDO->NetUpdateFrequency, 0.1f);
+		CharacterInfo.ReplicationPeriodFrame = FMath::Max<uint32>((uint32)FMath::RoundToFloat(NetDriver->NetServerMaxTickRate / NetUpdateFrequency), 1);
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, CharacterInfo);
+	}
+}
+
+void UMultiplayerReplicationGraph::InitGlobalGraphNodes()
+{
+	//Cells only create their dynamic node once the first actor moves in, so this has to be set before any are routed
+	if (bReplicateByDistance)
+	{
+		UReplicationGraphNode_GridCell::CreateDynamicNodeOverride = [](UReplicationGraphNode_GridCell* Parent)
+		{
+			return Parent->CreateChildNode<UReplicationGraphNode_DynamicSpatialFrequency>();
+		};
+	}
+	else
+	{
+		UReplicationGraphNode_GridCell::CreateDynamicNodeOverride = nullptr;
+	}
+
+	Super::InitGlobalGraphNodes();
+
+	GridNode->CellSize = CellSize;
+	GridNode->SpatialBias = SpatialBias;
+
+	PlayerStateNode = CreateNewNode<UReplicationGraphNode_PlayerStateFrequencyLimiter>();
+	PlayerStateNode->TargetActorsPerFrame = FMath::Max(PlayerStatesPerFrame, 1);
+	AddGlobalGraphNode(PlayerStateNode);
+}
+
+void UMultiplayerReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	//Player states are always relevant, a full server would send all of them every time any changes
+	if (ActorInfo.Class->IsChildOf(APlayerState::StaticClass()))
+	{
+		PlayerStateNode->NotifyAddNetworkActor(ActorInfo);
+		return;
+	}
+
+	Super::RouteAddNetworkActorToNodes(ActorInfo, GlobalInfo);
+}
+
+void UMultiplayerReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	if (ActorInfo.Class->IsChildOf(APlayerState::StaticClass()))
+	{
+		PlayerStateNode->NotifyRemoveNetworkActor(ActorInfo);
+		return;
+	}
+
+	Super::RouteRemoveNetworkActorToNodes(ActorInfo);
+}
+
+int32 UMultiplayerReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 NumReplicated = Super::ServerReplicateActors(DeltaSeconds);
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	const int32 NumConnections = Connections.Num();
+	if (NumConnections > 0)
+	{
+		FReplicationTickStats& Stats = TickStats.FindOrAdd(FMath::DivideAndRoundUp(NumConnections, ConnectionBucketSize) * ConnectionBucketSize);
+		++Stats.Ticks;
+		Stats.LastMs = ElapsedMs;
+		Stats.TotalMs += ElapsedMs;
+		Stats.MaxMs = FMath::Max(Stats.MaxMs, ElapsedMs);
+	}
+
+	return NumReplicated;
+}
+
+void UMultiplayerReplicationGraph::DumpReplicationStats(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Replication graph: %d connections, %.0fcm cells, characters culled at %.0fcm, %s"),
+		Connections.Num(), CellSize, CharacterCullDistance, bReplicateByDistance ? TEXT("replicated by distance") : TEXT("replicated at a fixed rate"));
+
+	TArray<int32> Buckets;
+	TickStats.GetKeys(Buckets);
+	Buckets.Sort();
+
+	for (int32 Bucket : Buckets)
+	{
+		const FReplicationTickStats& Stats = TickStats[Bucket];
+		Ar.Logf(TEXT("  up to %3d connections: %d ticks, last %.2fms, mean %.2fms, max %.2fms"),
+			Bucket, Stats.Ticks, Stats.LastMs, Stats.GetAverageMs(), Stats.MaxMs);
+	}
+}
+
+void UMultiplayerReplicationGraph::ResetReplicationStats()
+{
+	TickStats.Reset();
+}
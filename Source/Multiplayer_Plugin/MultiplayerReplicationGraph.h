@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BasicReplicationGraph.h"
+#include "MultiplayerReplicationGraph.generated.h"
+
+class UReplicationGraphNode_PlayerStateFrequencyLimiter;
+
+/**
+ * Time spent replicating actors in one net tick, for the connection counts the server had while it was measured
+ */
+struct FReplicationTickStats
+{
+	int32 Ticks = 0;
+
+	double LastMs = 0.0;
+	double TotalMs = 0.0;
+	double MaxMs = 0.0;
+
+	double GetAverageMs() const
+	{
+		return Ticks > 0 ? TotalMs / Ticks : 0.0;
+	}
+};
+
+/**
+ * Buckets characters into a 2D grid so every connection only looks at the cells around its view, instead of every
+ * character being checked against every connection. Characters replicate at the rate the net frequency subsystem
+ * picks for them, player states are spread over several frames.
+ */
+UCLASS(transient, config=Engine)
+class MULTIPLAYER_PLUGIN_API UMultiplayerReplicationGraph : public UBasicReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	//The graph replacing the world's net driver's replication, null without one
+	static UMultiplayerReplicationGraph* GetForWorld(const UWorld* World);
+
+	//Net frames between updates of one actor, for every connection. Characters in distance replicated cells keep their zone's rate
+	void SetActorReplicationPeriod(AActor* Actor, uint32 ReplicationPeriodFrame);
+
+	//Replication time per tick by connection count, also printed by "Multiplayer.RepGraph.Dump"
+	void DumpReplicationStats(FOutputDevice& Ar) const;
+	void ResetReplicationStats();
+
+	//Connection counts are measured in buckets of this many, so 25, 50 and 100 players each get a row
+	static constexpr int32 ConnectionBucketSize = 25;
+
+protected:
+
+	//Side of a grid cell in cm, connections gather the actors of every cell their cull distance reaches
+	UPROPERTY(Config)
+	float CellSize = 10000.0f;
+
+	//Lowest corner of the playable area, actors below it all pile into the edge cells
+	UPROPERTY(Config)
+	FVector2D SpatialBias = FVector2D(-200000.0f, -200000.0f);
+
+	//Characters further than this from a connection's view aren't replicated to it
+	UPROPERTY(Config)
+	float CharacterCullDistance = 15000.0f;
+
+	//Characters in front of and close to the view replicate every net frame, further and behind ones less often.
+	//Replaces the per character rates of the net frequency subsystem, so it is off unless that is too
+	UPROPERTY(Config)
+	bool bReplicateByDistance = false;
+
+	//Player states replicated per frame across all connections, the rest wait their turn
+	UPROPERTY(Config)
+	int32 PlayerStatesPerFrame = 10;
+
+	UPROPERTY()
+	UReplicationGraphNode_PlayerStateFrequencyLimiter* PlayerStateNode;
+
+private:
+
+	TMap<int32, FReplicationTickStats> TickStats;
+};
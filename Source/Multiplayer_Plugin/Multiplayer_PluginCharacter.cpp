@@ -7,13 +7,18 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "MultiplayerCharacterMovementComponent.h"
+#include "Net/UnrealNetwork.h"
 #include "OnlineSessionSettings.h"
 #include "OnlineSubsystem.h"
 
 //////////////////////////////////////////////////////////////////////////
 // AMultiplayer_PluginCharacter
 
-AMultiplayer_PluginCharacter::AMultiplayer_PluginCharacter() :
+AMultiplayer_PluginCharacter::AMultiplayer_PluginCharacter(const FObjectInitializer& ObjectInitializer) :
+	//Quantized, delta encoded client moves
+	Super(ObjectInitializer.SetDefaultSubobjectClass<UMultiplayerCharacterMovementComponent>(ACharacter::CharacterMovementComponentName)),
+
 	//Member Intializer List
 
 	//###ThisClass_is_typedef_for_current_class###
@@ -57,6 +62,8 @@ AMultiplayer_PluginCharacter::AMultiplayer_PluginCharacter() :
 	GetCharacterMovement()->MinAnalogWalkSpeed = 20.f;
 	GetCharacterMovement()->BrakingDecelerationWalking = 2000.f;
 
+	// Dedicated servers never render, the camera and its boom are only built into clients and listen servers
+#if !UE_SERVER
 	// Create a camera boom (pulls in towards the player if there is a collision)
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
 	CameraBoom->SetupAttachment(RootComponent);
@@ -67,26 +74,7 @@ AMultiplayer_PluginCharacter::AMultiplayer_PluginCharacter() :
 	FollowCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
 	FollowCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
-
-	//To Get OnlineSubsytem Pointer
-	IOnlineSubsystem* OnlineSubsystem = IOnlineSubsystem::Get();
-
-	if (OnlineSubsystem)
-	{
-		// To Setup SessionInterface Settings
-		OnlineSessionInterface = OnlineSubsystem->GetSessionInterface();
-		if (GEngine)
-		{
-			GEngine->AddOnScreenDebugMessage
-			(	-1,
-				20.0f,
-				FColor::Green,
-				FString::Printf(TEXT("OnlineSubsystem name is %s "), *OnlineSubsystem->GetSubsystemName().ToString())
-			);
-		}
-
-	}
-
+#endif
 
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named ThirdPersonCharacter (to avoid direct content references in C++)
@@ -129,6 +117,99 @@ void AMultiplayer_PluginCharacter::TouchStopped(ETouchIndex::Type FingerIndex, F
 	StopJumping();
 }
 
+//////////////////////////////////////////////////////////////////////////
+// Replication
+
+void AMultiplayer_PluginCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	//Same condition and notify as the ReplicatedMovement it stands in for
+	FDoRepLifetimeParams Params;
+	Params.Condition = COND_SimulatedOrPhysics;
+	Params.RepNotifyCondition = REPNOTIFY_Always;
+	DOREPLIFETIME_WITH_PARAMS_FAST(AMultiplayer_PluginCharacter, CompactMovement, Params);
+}
+
+void AMultiplayer_PluginCharacter::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	//Gathers the current movement into ReplicatedMovement
+	Super::PreReplication(ChangedPropertyTracker);
+
+	//The compact format has no room for physics state, a ragdoll goes back to the stock one
+	const bool bCompactMovement = IsReplicatingMovement() && !GetReplicatedMovement().bRepPhysics;
+	if (bCompactMovement)
+	{
+		CompactMovement.FromRepMovement(GetReplicatedMovement());
+	}
+
+	DOREPLIFETIME_ACTIVE_OVERRIDE_PRIVATE_PROPERTY(AActor, ReplicatedMovement, IsReplicatingMovement() && !bCompactMovement);
+	DOREPLIFETIME_ACTIVE_OVERRIDE(AMultiplayer_PluginCharacter, CompactMovement, bCompactMovement);
+}
+
+void AMultiplayer_PluginCharacter::OnRep_CompactMovement()
+{
+	//Decoded into the actor's own replicated movement, so the engine's proxy smoothing runs on it unchanged
+	CompactMovement.ToRepMovement(GetReplicatedMovement_Mutable());
+	OnRep_ReplicatedMovement();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Pooling
+
+void AMultiplayer_PluginCharacter::EnterPool(const FVector& ParkingLocation)
+{
+	bPooled = true;
+
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
+	Movement->StopMovementImmediately();
+	Movement->DisableMovement();
+	Movement->SetComponentTickEnabled(false);
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	SetActorLocation(ParkingLocation, false, nullptr, ETeleportType::ResetPhysics);
+
+	//Goes dormant once clients have seen it hidden, nothing is sent for it while it waits
+	SetNetDormancy(DORM_DormantAll);
+}
+
+void AMultiplayer_PluginCharacter::LeavePool(const FTransform& SpawnTransform)
+{
+	bPooled = false;
+
+	SetActorLocationAndRotation(SpawnTransform.GetLocation(), SpawnTransform.GetRotation(), false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
+	Movement->SetComponentTickEnabled(true);
+	Movement->SetDefaultMovementMode();
+	ResetJumpState();
+
+	SetNetDormancy(DORM_Awake);
+	ForceNetUpdate();
+}
+
+void AMultiplayer_PluginCharacter::ApplyBotInput(float Forward, float Right, float TurnRate, bool bJump)
+{
+	MoveForward(Forward);
+	MoveRight(Right);
+	TurnAtRate(TurnRate);
+
+	//Released once like a key, stopping every frame would reset the jump state mid-air
+	if (bJump)
+	{
+		Jump();
+	}
+	else if (bPressedJump)
+	{
+		StopJumping();
+	}
+}
+
 void AMultiplayer_PluginCharacter::TurnAtRate(float Rate)
 {
 	// calculate delta for this frame from the rate information
@@ -170,9 +251,39 @@ void AMultiplayer_PluginCharacter::MoveRight(float Value)
 	}
 }
 
+bool AMultiplayer_PluginCharacter::InitSessionInterface()
+{
+	//Looked up on first use instead of in the constructor, every spawned character used to pay for it
+	if (OnlineSessionInterface.IsValid())
+	{
+		return true;
+	}
+
+	//To Get OnlineSubsytem Pointer
+	IOnlineSubsystem* OnlineSubsystem = IOnlineSubsystem::Get();
+
+	if (OnlineSubsystem)
+	{
+		// To Setup SessionInterface Settings
+		OnlineSessionInterface = OnlineSubsystem->GetSessionInterface();
+		if (GEngine)
+		{
+			GEngine->AddOnScreenDebugMessage
+			(	-1,
+				20.0f,
+				FColor::Green,
+				FString::Printf(TEXT("OnlineSubsystem name is %s "), *OnlineSubsystem->GetSubsystemName().ToString())
+			);
+		}
+
+	}
+
+	return OnlineSessionInterface.IsValid();
+}
+
 void AMultiplayer_PluginCharacter::CreateGameSession()
 {
-	if (!OnlineSessionInterface.IsValid())
+	if (!InitSessionInterface())
 	{
 		return;
 	}
@@ -226,7 +337,7 @@ void AMultiplayer_PluginCharacter::JoinGameSession()
 		FString::Printf(TEXT("Join Session Was Function"))
 	);
 
-	if (!OnlineSessionInterface.IsValid())
+	if (!InitSessionInterface())
 	{
 		return;
 	}
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "MultiplayerCharacterMovementComponent.h"
 
 #include "Multiplayer_PluginCharacter.generated.h"
 
@@ -21,7 +22,7 @@ class AMultiplayer_PluginCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FollowCamera;
 public:
-	AMultiplayer_PluginCharacter();
+	AMultiplayer_PluginCharacter(const FObjectInitializer& ObjectInitializer);
 
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Input)
@@ -58,12 +59,38 @@ protected:
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	// End of APawn interface
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+	/** Sent to simulated proxies in place of ReplicatedMovement, which only still goes out while the character simulates physics */
+	UPROPERTY(ReplicatedUsing = OnRep_CompactMovement)
+	FMultiplayerRepMovement CompactMovement;
+
+	UFUNCTION()
+	void OnRep_CompactMovement();
+
 public:
-	/** Returns CameraBoom subobject **/
+	/** Returns CameraBoom subobject, null on dedicated servers **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
-	/** Returns FollowCamera subobject **/
+	/** Returns FollowCamera subobject, null on dedicated servers **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
 
+public:
+	/** Hides, parks and makes dormant a character the game mode keeps for a later spawn */
+	void EnterPool(const FVector& ParkingLocation);
+
+	/** Brings a pooled character back at the spawn point, reset like a freshly spawned one */
+	void LeavePool(const FTransform& SpawnTransform);
+
+	bool IsPooled() const { return bPooled; }
+
+	/**
+	 * Scripted input through the same paths as the bound axes, for headless bot clients.
+	 * @param Forward, Right	Axis values in -1..1
+	 * @param TurnRate		Normalized turn rate, as for TurnAtRate
+	 */
+	void ApplyBotInput(float Forward, float Right, float TurnRate, bool bJump);
+
 public:
 		//Pointer to online session interface
 		IOnlineSessionPtr OnlineSessionInterface;
@@ -84,6 +111,10 @@ protected:
 
 private:
 
+	//Looks up the session interface the first time a session call needs it
+	bool InitSessionInterface();
+
+	bool bPooled = false;
 
 	FOnCreateSessionCompleteDelegate CreateSessionCompleteDelegate; //Create Session Delegate
 	FOnFindSessionsCompleteDelegate FindSessionsCompleteDelegate;	// Find Session Delegate
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Multiplayer_PluginCharacter.h"
+#include "Components/ActorComponent.h"
+#include "GameFramework/GameStateBase.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Serialization/ArchiveCountMem.h"
+
+namespace
+{
+	//Resident memory with nobody connected, per player numbers are measured against it
+	uint64 BaselineResidentBytes = 0;
+
+	//Object memory of one character and its components, the part a server target without cosmetic subobjects shrinks
+	uint64 GetCharacterObjectBytes(AMultiplayer_PluginCharacter* Character)
+	{
+		TArray<UObject*> Objects;
+		Objects.Add(Character);
+		for (UActorComponent* Component : Character->GetComponents())
+		{
+			Objects.Add(Component);
+		}
+
+		uint64 Bytes = 0;
+		for (UObject* Object : Objects)
+		{
+			FArchiveCountMem CountMem(Object);
+			Bytes += CountMem.GetMax() + Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		}
+		return Bytes;
+	}
+
+	void PrintMemoryReport(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		const uint64 ResidentBytes = FPlatformMemory::GetStats().UsedPhysical;
+		if (Args.Num() > 0 && Args[0] == TEXT("Baseline"))
+		{
+			BaselineResidentBytes = ResidentBytes;
+		}
+
+		const int32 NumPlayers = World && World->GetGameState() ? World->GetGameState()->PlayerArray.Num() : 0;
+		const int64 ExecutableBytes = IFileManager::Get().FileSize(FPlatformProcess::ExecutablePath());
+
+		int32 NumCharacters = 0;
+		uint64 CharacterBytes = 0;
+		int32 NumComponents = 0;
+		if (World)
+		{
+			for (TActorIterator<AMultiplayer_PluginCharacter> It(World); It; ++It)
+			{
+				CharacterBytes += GetCharacterObjectBytes(*It);
+				NumComponents += It->GetComponents().Num();
+				++NumCharacters;
+			}
+		}
+
+		const double MegaByte = 1024.0 * 1024.0;
+		Ar.Logf(TEXT("Memory report, %s build, executable %.1f MB"), UE_SERVER ? TEXT("server") : TEXT("game"), ExecutableBytes / MegaByte);
+		Ar.Logf(TEXT("  resident %.1f MB, baseline %.1f MB, %d players"), ResidentBytes / MegaByte, BaselineResidentBytes / MegaByte, NumPlayers);
+		if (BaselineResidentBytes > 0 && NumPlayers > 0)
+		{
+			Ar.Logf(TEXT("  resident per player %.1f KB"), (double(ResidentBytes) - double(BaselineResidentBytes)) / NumPlayers / 1024.0);
+		}
+		if (NumCharacters > 0)
+		{
+			Ar.Logf(TEXT("  %d characters, %.1f KB and %.1f components each"),
+				NumCharacters, CharacterBytes / 1024.0 / NumCharacters, float(NumComponents) / NumCharacters);
+		}
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice MemoryReportCommand(
+		TEXT("Multiplayer.Memory.Report"),
+		TEXT("Prints resident memory per player, character object memory and executable size. \"Baseline\" first records the empty server"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&PrintMemoryReport));
+}